@@ -5,28 +5,128 @@ BandFilterSection::BandFilterSection(juce::AudioProcessorValueTreeState& apvts,
     const juce::String& gainParamId,
     const juce::String& qualityParamId,
     const juce::String& bypassParamId,
+    const juce::String& typeParamId,
+    const juce::StringArray& typeLabels,
+    const juce::String& placementParamId,
+    const juce::StringArray& placementLabels,
+    const juce::String& lfoRateParamId,
+    const juce::String& lfoDepthParamId,
+    const juce::String& envDepthParamId,
+    const juce::String& dynamicParamId,
+    const juce::String& thresholdParamId,
+    const juce::String& ratioParamId,
+    const juce::String& attackParamId,
+    const juce::String& releaseParamId,
     const juce::String& title,
     juce::Colour accentColour)
     : SectionPanel(apvts, bypassParamId, title, accentColour),
     freqSlider(*apvts.getParameter(freqParamId), "Hz", "FREQ"),
     gainSlider(*apvts.getParameter(gainParamId), "dB", "GAIN"),
     qualitySlider(*apvts.getParameter(qualityParamId), "", "Q"),
+    lfoRateSlider(*apvts.getParameter(lfoRateParamId), "Hz", "RATE"),
+    lfoDepthSlider(*apvts.getParameter(lfoDepthParamId), "Oct", "LFO"),
+    envDepthSlider(*apvts.getParameter(envDepthParamId), "Oct", "ENV"),
+    thresholdSlider(*apvts.getParameter(thresholdParamId), "dB", "THR"),
+    ratioSlider(*apvts.getParameter(ratioParamId), ":1", "RATIO"),
+    attackSlider(*apvts.getParameter(attackParamId), "ms", "ATK"),
+    releaseSlider(*apvts.getParameter(releaseParamId), "ms", "REL"),
+    typeCombo(typeParamId, "", "TYPE", accentColour),
+    placementCombo(placementParamId, "", "CH", accentColour),
     freqAttachment(apvts, freqParamId, freqSlider),
     gainAttachment(apvts, gainParamId, gainSlider),
-    qualityAttachment(apvts, qualityParamId, qualitySlider)
+    qualityAttachment(apvts, qualityParamId, qualitySlider),
+    lfoRateAttachment(apvts, lfoRateParamId, lfoRateSlider),
+    lfoDepthAttachment(apvts, lfoDepthParamId, lfoDepthSlider),
+    envDepthAttachment(apvts, envDepthParamId, envDepthSlider),
+    thresholdAttachment(apvts, thresholdParamId, thresholdSlider),
+    ratioAttachment(apvts, ratioParamId, ratioSlider),
+    attackAttachment(apvts, attackParamId, attackSlider),
+    releaseAttachment(apvts, releaseParamId, releaseSlider),
+    dynamicAttachment(apvts, dynamicParamId, dynamicButton)
 {
+    for (int i = 0; i < typeLabels.size(); ++i)
+        typeCombo.addItem(typeLabels[i], i + 1);
+
+    typeAttachment = std::make_unique<ComboBoxAttachment>(apvts, typeParamId, typeCombo);
+
+    for (int i = 0; i < placementLabels.size(); ++i)
+        placementCombo.addItem(placementLabels[i], i + 1);
+
+    placementAttachment = std::make_unique<ComboBoxAttachment>(apvts, placementParamId, placementCombo);
+
     addAndMakeVisible(freqSlider);
     addAndMakeVisible(gainSlider);
     addAndMakeVisible(qualitySlider);
+    addAndMakeVisible(lfoRateSlider);
+    addAndMakeVisible(lfoDepthSlider);
+    addAndMakeVisible(envDepthSlider);
+    addAndMakeVisible(typeCombo);
+    addAndMakeVisible(placementCombo);
+
+    addChildComponent(thresholdSlider);
+    addChildComponent(ratioSlider);
+    addChildComponent(attackSlider);
+    addChildComponent(releaseSlider);
+
+    dynamicButton.setClickingTogglesState(true);
+    dynamicButton.setColour(juce::TextButton::buttonOnColourId, accentColour);
+    dynamicButton.onStateChange = [this] { updateDynamicsVisibility(); };
+    addAndMakeVisible(dynamicButton);
+
+    updateDynamicsVisibility();
+}
+
+void BandFilterSection::updateDynamicsVisibility()
+{
+    const bool isDynamic = dynamicButton.getToggleState();
+
+    if (thresholdSlider.isVisible() == isDynamic)
+        return;
+
+    for (auto* slider : { &thresholdSlider, &ratioSlider, &attackSlider, &releaseSlider })
+        slider->setVisible(isDynamic);
+
+    for (auto* slider : { &lfoRateSlider, &lfoDepthSlider, &envDepthSlider })
+        slider->setVisible(!isDynamic);
+
+    resized();
 }
 
 void BandFilterSection::layoutControls(juce::Rectangle<int> area)
 {
-    static constexpr float GapRatio = 0.08f;
+    static constexpr float GapRatio = 0.04f;
+    static constexpr float TypeRatio = 0.09f;
+    static constexpr float ModulationRatio = 0.22f;
+    static constexpr float DynamicsRatio = 0.36f;
     static constexpr float FreqRatio = 0.33f;
     static constexpr float GainRatio = 0.50f;
 
     area.removeFromTop(static_cast<int>(area.getHeight() * GapRatio));
+    auto comboRow = area.removeFromTop(static_cast<int>(area.getHeight() * TypeRatio));
+    const int comboRowWidth = comboRow.getWidth();
+    typeCombo.setBounds(comboRow.removeFromLeft(comboRowWidth * 9 / 20));
+    placementCombo.setBounds(comboRow.removeFromLeft(comboRowWidth * 6 / 20));
+    dynamicButton.setBounds(comboRow.reduced(1, 2));
+
+    if (dynamicButton.getToggleState())
+    {
+        // Dynamics in a two-by-two grid along the bottom
+        auto dynamicsArea = area.removeFromBottom(static_cast<int>(area.getHeight() * DynamicsRatio));
+        auto topRow = dynamicsArea.removeFromTop(dynamicsArea.getHeight() / 2);
+        thresholdSlider.setBounds(topRow.removeFromLeft(topRow.getWidth() / 2));
+        ratioSlider.setBounds(topRow);
+        attackSlider.setBounds(dynamicsArea.removeFromLeft(dynamicsArea.getWidth() / 2));
+        releaseSlider.setBounds(dynamicsArea);
+    }
+    else
+    {
+        // Modulation row along the bottom
+        auto modulationArea = area.removeFromBottom(static_cast<int>(area.getHeight() * ModulationRatio));
+        const int modulationWidth = modulationArea.getWidth() / 3;
+        lfoRateSlider.setBounds(modulationArea.removeFromLeft(modulationWidth));
+        lfoDepthSlider.setBounds(modulationArea.removeFromLeft(modulationWidth));
+        envDepthSlider.setBounds(modulationArea);
+    }
 
     freqSlider.setBounds(area.removeFromTop(static_cast<int>(area.getHeight() * FreqRatio)));
     gainSlider.setBounds(area.removeFromTop(static_cast<int>(area.getHeight() * GainRatio)));
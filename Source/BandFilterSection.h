@@ -1,6 +1,7 @@
 #pragma once
 #include "SectionPanel.h"
 #include "CustomRotarySlider.h"
+#include "MinimalCombo.h"
 
 class BandFilterSection : public SectionPanel
 {
@@ -10,6 +11,18 @@ public:
         const juce::String& gainParamId,
         const juce::String& qualityParamId,
         const juce::String& bypassParamId,
+        const juce::String& typeParamId,
+        const juce::StringArray& typeLabels,
+        const juce::String& placementParamId,
+        const juce::StringArray& placementLabels,
+        const juce::String& lfoRateParamId,
+        const juce::String& lfoDepthParamId,
+        const juce::String& envDepthParamId,
+        const juce::String& dynamicParamId,
+        const juce::String& thresholdParamId,
+        const juce::String& ratioParamId,
+        const juce::String& attackParamId,
+        const juce::String& releaseParamId,
         const juce::String& title,
         juce::Colour accentColour);
 
@@ -17,11 +30,37 @@ protected:
     CustomRotarySlider freqSlider;
     CustomRotarySlider gainSlider;
     CustomRotarySlider qualitySlider;
+    CustomRotarySlider lfoRateSlider;
+    CustomRotarySlider lfoDepthSlider;
+    CustomRotarySlider envDepthSlider;
+    CustomRotarySlider thresholdSlider;
+    CustomRotarySlider ratioSlider;
+    CustomRotarySlider attackSlider;
+    CustomRotarySlider releaseSlider;
+    MinimalCombo typeCombo;
+    MinimalCombo placementCombo;
+    juce::TextButton dynamicButton{ "DYN" };
 
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
     SliderAttachment freqAttachment;
     SliderAttachment gainAttachment;
     SliderAttachment qualityAttachment;
+    SliderAttachment lfoRateAttachment;
+    SliderAttachment lfoDepthAttachment;
+    SliderAttachment envDepthAttachment;
+    SliderAttachment thresholdAttachment;
+    SliderAttachment ratioAttachment;
+    SliderAttachment attackAttachment;
+    SliderAttachment releaseAttachment;
+    ButtonAttachment dynamicAttachment;
+    std::unique_ptr<ComboBoxAttachment> typeAttachment;
+    std::unique_ptr<ComboBoxAttachment> placementAttachment;
 
     void layoutControls(juce::Rectangle<int> area) override;
+
+    // The bottom of the panel shows the dynamics controls while the band is
+    // dynamic, and the modulation controls otherwise
+    void updateDynamicsVisibility();
 };
\ No newline at end of file
@@ -0,0 +1,613 @@
+#include "BiquadCascade.h"
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, int numSectionsToUse)
+{
+    jassert(numSectionsToUse >= 0);
+
+    numSections = numSectionsToUse;
+    numChannels = static_cast<int>(spec.numChannels);
+    maximumBlockSize = static_cast<int>(spec.maximumBlockSize);
+    setSampleRate(spec.sampleRate);
+
+   #if JUCE_USE_SIMD
+    interleaved.resize(numChannels > 1 ? static_cast<size_t>(maximumBlockSize) : 0);
+   #endif
+
+    coefficients.resize(static_cast<size_t>(numSections * numCoefficientSets * CoefficientDesigner::biquadSize));
+    state.resize(static_cast<size_t>(numChannels * numSections * stateSize));
+    activeFlags.resize(static_cast<size_t>(numSections));
+    fades.resize(static_cast<size_t>(numSections));
+    processedSections.resize(static_cast<size_t>(numSections));
+
+    for (int section = 0; section < numSections; ++section)
+        for (int set = 0; set < numCoefficientSets; ++set)
+            CoefficientDesigner::makeIdentity(getCoefficients(section, set));
+
+    std::fill(activeFlags.begin(), activeFlags.end(), 0);
+    std::fill(fades.begin(), fades.end(), Fade());
+    numProcessed = 0;
+    hasProcessed = false;
+
+    reset();
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setSampleRate(double newSampleRate)
+{
+    // Fades already running keep their step and finish at the old pace
+    fadeLength = juce::roundToInt(newSampleRate * fadeSeconds);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::reset()
+{
+    std::fill(state.begin(), state.end(), SampleType(0));
+}
+
+template <typename SampleType>
+SampleType* BiquadCascade<SampleType>::getCoefficients(int section, int set)
+{
+    jassert(juce::isPositiveAndBelow(section, numSections));
+    jassert(juce::isPositiveAndBelow(set, numCoefficientSets));
+    return coefficients.data() + (section * numCoefficientSets + set) * CoefficientDesigner::biquadSize;
+}
+
+template <typename SampleType>
+const SampleType* BiquadCascade<SampleType>::getCoefficients(int section, int set) const
+{
+    jassert(juce::isPositiveAndBelow(section, numSections));
+    jassert(juce::isPositiveAndBelow(set, numCoefficientSets));
+    return coefficients.data() + (section * numCoefficientSets + set) * CoefficientDesigner::biquadSize;
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setChannelMode(ChannelMode newMode)
+{
+    if (newMode == channelMode)
+        return;
+
+    const auto wasMidSide = isMidSide();
+    channelMode = newMode;
+
+    if (isMidSide() != wasMidSide)
+        convertState(isMidSide());
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::convertState(bool toMidSide)
+{
+    // The state is linear in the signal, so it goes through the same matrix
+    // as the audio: exact where both channels share coefficients, and close
+    // enough elsewhere to carry on without the jump of a cleared state
+    const auto scale = toMidSide ? SampleType(0.5) : SampleType(1);
+    auto* first = state.data();
+    auto* second = state.data() + numSections * stateSize;
+
+    for (int i = 0; i < numSections * stateSize; ++i)
+    {
+        const auto sum = (first[i] + second[i]) * scale;
+        const auto difference = (first[i] - second[i]) * scale;
+        first[i] = sum;
+        second[i] = difference;
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::clearState(int section)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* sectionState = state.data() + (channel * numSections + section) * stateSize;
+        std::fill(sectionState, sectionState + stateSize, SampleType(0));
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setActive(int section, bool shouldBeActive)
+{
+    jassert(juce::isPositiveAndBelow(section, numSections));
+
+    if (isActive(section) == shouldBeActive)
+        return;
+
+    auto& fade = fades[static_cast<size_t>(section)];
+    const auto wasProcessed = isActive(section) || fade.isRunning();
+
+    activeFlags[static_cast<size_t>(section)] = shouldBeActive ? 1 : 0;
+
+    if (shouldBeActive && ! wasProcessed)
+    {
+        clearState(section);
+        fade.gain = 0;
+    }
+
+    // Nothing has been heard since prepare, so there is nothing to click
+    if (fadeLength > 0 && hasProcessed)
+    {
+        // A fade already under way is reversed from where it is
+        const auto distance = shouldBeActive ? SampleType(1) - fade.gain : fade.gain;
+        fade.step = (shouldBeActive ? SampleType(1) : SampleType(-1)) / static_cast<SampleType>(fadeLength);
+        fade.remaining = juce::jmax(1, juce::roundToInt(distance * static_cast<SampleType>(fadeLength)));
+    }
+    else
+    {
+        fade = Fade();
+        fade.gain = shouldBeActive ? SampleType(1) : SampleType(0);
+    }
+
+    rebuildProcessedList();
+}
+
+template <typename SampleType>
+bool BiquadCascade<SampleType>::isActive(int section) const
+{
+    return activeFlags[static_cast<size_t>(section)] != 0;
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::loadDesign(const BiquadCascade& other)
+{
+    jassert(other.numSections == numSections);
+
+    std::copy(other.coefficients.begin(), other.coefficients.end(), coefficients.begin());
+    std::copy(other.activeFlags.begin(), other.activeFlags.end(), activeFlags.begin());
+
+    for (int section = 0; section < numSections; ++section)
+    {
+        fades[static_cast<size_t>(section)] = Fade();
+        fades[static_cast<size_t>(section)].gain = isActive(section) ? SampleType(1) : SampleType(0);
+    }
+
+    channelMode = other.channelMode;
+
+    reset();
+    rebuildProcessedList();
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::rebuildProcessedList()
+{
+    numProcessed = 0;
+
+    for (int section = 0; section < numSections; ++section)
+        if (isActive(section) || fades[static_cast<size_t>(section)].isRunning())
+            processedSections[static_cast<size_t>(numProcessed++)] = section;
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::advanceFades(int numSamples)
+{
+    bool fadeOutFinished = false;
+
+    for (int i = 0; i < numProcessed; ++i)
+    {
+        const auto section = processedSections[static_cast<size_t>(i)];
+        auto& fade = fades[static_cast<size_t>(section)];
+
+        if (! fade.isRunning())
+            continue;
+
+        const auto advance = juce::jmin(numSamples, fade.remaining);
+        fade.gain += fade.step * static_cast<SampleType>(advance);
+        fade.remaining -= advance;
+
+        if (! fade.isRunning())
+        {
+            fade.gain = isActive(section) ? SampleType(1) : SampleType(0);
+            fadeOutFinished = fadeOutFinished || ! isActive(section);
+        }
+    }
+
+    if (fadeOutFinished)
+        rebuildProcessedList();
+}
+
+//==============================================================================
+// Position within a section's fade for the samples being processed
+template <typename SampleType>
+struct FadeRamp
+{
+    SampleType gain, step, target;
+    int remaining;
+};
+
+template <typename SampleType, typename Fade>
+static FadeRamp<SampleType> getFadeRamp(const Fade& fade, int offset)
+{
+    const auto target = fade.step > 0 ? SampleType(1) : SampleType(0);
+
+    if (fade.remaining <= offset)
+    {
+        const auto finalGain = fade.isRunning() ? target : fade.gain;
+        return { finalGain, SampleType(0), finalGain, 0 };
+    }
+
+    return { fade.gain + fade.step * static_cast<SampleType>(offset), fade.step, target, fade.remaining - offset };
+}
+
+template <typename SampleType>
+static void processSection(SampleType* samples, int numSamples, const SampleType* coefficients, SampleType* sectionState)
+{
+    const auto b0 = coefficients[0];
+    const auto b1 = coefficients[1];
+    const auto b2 = coefficients[2];
+    const auto a1 = coefficients[3];
+    const auto a2 = coefficients[4];
+
+    auto lv1 = sectionState[0];
+    auto lv2 = sectionState[1];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto input = samples[i];
+        const auto output = input * b0 + lv1;
+        samples[i] = output;
+
+        lv1 = (input * b1) - (output * a1) + lv2;
+        lv2 = (input * b2) - (output * a2);
+    }
+
+    juce::dsp::util::snapToZero(lv1);
+    juce::dsp::util::snapToZero(lv2);
+
+    sectionState[0] = lv1;
+    sectionState[1] = lv2;
+}
+
+// Same kernel, mixing the filtered signal in by a ramping gain. The filter
+// itself always runs on its own output so its state stays valid.
+template <typename SampleType>
+static void processFadingSection(SampleType* samples, int numSamples, const SampleType* coefficients, SampleType* sectionState,
+                                 FadeRamp<SampleType> ramp)
+{
+    const auto b0 = coefficients[0];
+    const auto b1 = coefficients[1];
+    const auto b2 = coefficients[2];
+    const auto a1 = coefficients[3];
+    const auto a2 = coefficients[4];
+
+    auto lv1 = sectionState[0];
+    auto lv2 = sectionState[1];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto input = samples[i];
+        const auto output = input * b0 + lv1;
+        samples[i] = input + (output - input) * ramp.gain;
+
+        lv1 = (input * b1) - (output * a1) + lv2;
+        lv2 = (input * b2) - (output * a2);
+
+        if (ramp.remaining > 0)
+            ramp.gain = (--ramp.remaining == 0) ? ramp.target : ramp.gain + ramp.step;
+    }
+
+    juce::dsp::util::snapToZero(lv1);
+    juce::dsp::util::snapToZero(lv2);
+
+    sectionState[0] = lv1;
+    sectionState[1] = lv2;
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::processScalar(SampleType* samples, int channel, int numSamples)
+{
+    auto* channelState = state.data() + channel * numSections * stateSize;
+
+    for (int i = 0; i < numProcessed; ++i)
+    {
+        const auto section = processedSections[static_cast<size_t>(i)];
+        const auto* sectionCoefficients = getCoefficients(section, getCoefficientSet(channel));
+        auto* sectionState = channelState + section * stateSize;
+        const auto& fade = fades[static_cast<size_t>(section)];
+
+        if (fade.isRunning())
+            processFadingSection(samples, numSamples, sectionCoefficients, sectionState, getFadeRamp<SampleType>(fade, 0));
+        else
+            processSection(samples, numSamples, sectionCoefficients, sectionState);
+    }
+}
+
+#if JUCE_USE_SIMD
+template <typename SampleType>
+void BiquadCascade<SampleType>::processInterleaved(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, int numChannelsInBatch, int fadeOffset)
+{
+    constexpr auto lanes = static_cast<int>(Vector::size());
+    jassert(numChannelsInBatch <= lanes);
+
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    auto* frames = interleaved.data();
+    auto* rawFrames = reinterpret_cast<SampleType*>(frames);
+
+    // Unused lanes carry silence
+    for (int i = 0; i < numSamples; ++i)
+        frames[i] = Vector::expand(SampleType(0));
+
+    // The mid/side matrix is folded into the interleaving
+    const auto isEncoding = isMidSide() && firstChannel == 0 && numChannelsInBatch == 2;
+
+    if (isEncoding)
+    {
+        const auto* left = block.getChannelPointer(0);
+        const auto* right = block.getChannelPointer(1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            rawFrames[i * lanes] = (left[i] + right[i]) * SampleType(0.5);
+            rawFrames[i * lanes + 1] = (left[i] - right[i]) * SampleType(0.5);
+        }
+    }
+    else
+    {
+        for (int lane = 0; lane < numChannelsInBatch; ++lane)
+        {
+            const auto* source = block.getChannelPointer(static_cast<size_t>(firstChannel + lane));
+
+            for (int i = 0; i < numSamples; ++i)
+                rawFrames[i * lanes + lane] = source[i];
+        }
+    }
+
+    for (int s = 0; s < numProcessed; ++s)
+    {
+        const auto section = processedSections[static_cast<size_t>(s)];
+        auto ramp = getFadeRamp<SampleType>(fades[static_cast<size_t>(section)], fadeOffset);
+
+        // Each lane takes its channel's coefficient set
+        Vector b0, b1, b2, a1, a2;
+
+        for (size_t lane = 0; lane < Vector::size(); ++lane)
+        {
+            const auto* c = getCoefficients(section, getCoefficientSet(firstChannel + static_cast<int>(lane)));
+
+            b0.set(lane, c[0]);
+            b1.set(lane, c[1]);
+            b2.set(lane, c[2]);
+            a1.set(lane, c[3]);
+            a2.set(lane, c[4]);
+        }
+
+        auto lv1 = Vector::expand(SampleType(0));
+        auto lv2 = Vector::expand(SampleType(0));
+
+        for (int lane = 0; lane < numChannelsInBatch; ++lane)
+        {
+            const auto* sectionState = state.data() + ((firstChannel + lane) * numSections + section) * stateSize;
+            lv1.set(static_cast<size_t>(lane), sectionState[0]);
+            lv2.set(static_cast<size_t>(lane), sectionState[1]);
+        }
+
+        if (ramp.remaining == 0 && ramp.gain == SampleType(1))
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto input = frames[i];
+                const auto output = input * b0 + lv1;
+                frames[i] = output;
+
+                lv1 = (input * b1) - (output * a1) + lv2;
+                lv2 = (input * b2) - (output * a2);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto input = frames[i];
+                const auto output = input * b0 + lv1;
+                frames[i] = input + (output - input) * ramp.gain;
+
+                lv1 = (input * b1) - (output * a1) + lv2;
+                lv2 = (input * b2) - (output * a2);
+
+                if (ramp.remaining > 0)
+                    ramp.gain = (--ramp.remaining == 0) ? ramp.target : ramp.gain + ramp.step;
+            }
+        }
+
+        // Per-lane denormal snapping, as the scalar kernel does
+        for (int lane = 0; lane < numChannelsInBatch; ++lane)
+        {
+            auto* sectionState = state.data() + ((firstChannel + lane) * numSections + section) * stateSize;
+            sectionState[0] = lv1.get(static_cast<size_t>(lane));
+            sectionState[1] = lv2.get(static_cast<size_t>(lane));
+
+            juce::dsp::util::snapToZero(sectionState[0]);
+            juce::dsp::util::snapToZero(sectionState[1]);
+        }
+    }
+
+    if (isEncoding)
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto mid = rawFrames[i * lanes];
+            const auto side = rawFrames[i * lanes + 1];
+
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+    else
+    {
+        for (int lane = 0; lane < numChannelsInBatch; ++lane)
+        {
+            auto* destination = block.getChannelPointer(static_cast<size_t>(firstChannel + lane));
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = rawFrames[i * lanes + lane];
+        }
+    }
+}
+#endif
+
+// Used by the scalar path only; the vector path encodes while interleaving
+template <typename SampleType>
+static void encodeMidSide(SampleType* left, SampleType* right, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto mid = (left[i] + right[i]) * SampleType(0.5);
+        const auto side = (left[i] - right[i]) * SampleType(0.5);
+
+        left[i] = mid;
+        right[i] = side;
+    }
+}
+
+template <typename SampleType>
+static void decodeMidSide(SampleType* mid, SampleType* side, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto left = mid[i] + side[i];
+        const auto right = mid[i] - side[i];
+
+        mid[i] = left;
+        side[i] = right;
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+{
+    hasProcessed = true;
+
+    if (context.isBypassed || numProcessed == 0)
+        return;
+
+    const auto& block = context.getOutputBlock();
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto channelsToProcess = juce::jmin(static_cast<int>(block.getNumChannels()), numChannels);
+
+    int channel = 0;
+
+   #if JUCE_USE_SIMD
+    // Channels are filtered in batches as wide as a register, sharing one
+    // pass and one set of coefficients. A single leftover channel takes the
+    // scalar path rather than paying for a mostly empty register. The
+    // interleaving buffer is sized for the prepared block size, so larger
+    // host blocks are split.
+    constexpr auto lanes = static_cast<int>(Vector::size());
+
+    while (channelsToProcess - channel >= 2 && ! interleaved.empty())
+    {
+        const auto numChannelsInBatch = juce::jmin(lanes, channelsToProcess - channel);
+
+        for (int start = 0; start < numSamples; start += maximumBlockSize)
+        {
+            const auto length = juce::jmin(maximumBlockSize, numSamples - start);
+            processInterleaved(block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length)), channel, numChannelsInBatch, start);
+        }
+
+        channel += numChannelsInBatch;
+    }
+   #endif
+
+    const auto needsMidSideMatrix = isMidSide() && channel == 0 && channelsToProcess == 2;
+
+    if (needsMidSideMatrix)
+        encodeMidSide(block.getChannelPointer(0), block.getChannelPointer(1), numSamples);
+
+    for (; channel < channelsToProcess; ++channel)
+        processScalar(block.getChannelPointer(static_cast<size_t>(channel)), channel, numSamples);
+
+    if (needsMidSideMatrix)
+        decodeMidSide(block.getChannelPointer(0), block.getChannelPointer(1), numSamples);
+
+    advanceFades(numSamples);
+}
+
+template <typename SampleType>
+int BiquadCascade<SampleType>::getTailLengthSamples(double threshold) const
+{
+    jassert(threshold > 0.0 && threshold < 1.0);
+
+    const auto logThreshold = std::log(threshold);
+    double tail = 0.0;
+
+    const auto numSetsInUse = channelMode == ChannelMode::Shared ? 1 : numCoefficientSets;
+
+    for (int section = 0; section < numSections; ++section)
+    {
+        if (! isActive(section))
+            continue;
+
+        // Poles are the roots of z^2 + a1 z + a2; the slower of the sets counts
+        double radius = 0.0;
+
+        for (int set = 0; set < numSetsInUse; ++set)
+        {
+            const auto a1 = static_cast<double>(getCoefficients(section, set)[3]);
+            const auto a2 = static_cast<double>(getCoefficients(section, set)[4]);
+            const auto discriminant = a1 * a1 - 4.0 * a2;
+
+            if (discriminant < 0.0)
+            {
+                radius = juce::jmax(radius, std::sqrt(a2));
+            }
+            else
+            {
+                const auto root = std::sqrt(discriminant);
+                radius = juce::jmax(radius, std::abs(-a1 + root) * 0.5, std::abs(-a1 - root) * 0.5);
+            }
+        }
+
+        if (radius >= 1.0)
+            return std::numeric_limits<int>::max();
+
+        if (radius > 0.0)
+            tail += logThreshold / std::log(radius);
+    }
+
+    return static_cast<int>(juce::jmin(std::ceil(tail), static_cast<double>(std::numeric_limits<int>::max())));
+}
+
+template <typename SampleType>
+SampleType BiquadCascade<SampleType>::getStateMagnitude() const
+{
+    SampleType magnitude = 0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int i = 0; i < numProcessed; ++i)
+        {
+            const auto* sectionState = state.data() + (channel * numSections + processedSections[static_cast<size_t>(i)]) * stateSize;
+            magnitude = juce::jmax(magnitude, std::abs(sectionState[0]), std::abs(sectionState[1]));
+        }
+    }
+
+    return magnitude;
+}
+
+template <typename SampleType>
+double BiquadCascade<SampleType>::getMagnitudeForFrequency(double frequency, double sampleRate, int set) const
+{
+    jassert(sampleRate > 0.0);
+
+    const std::complex<double> jw = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+    const auto jw2 = jw * jw;
+    double magnitude = 1.0;
+
+    for (int section = 0; section < numSections; ++section)
+    {
+        if (! isActive(section))
+            continue;
+
+        const auto* c = getCoefficients(section, set);
+
+        const auto numerator = static_cast<double>(c[0]) + static_cast<double>(c[1]) * jw + static_cast<double>(c[2]) * jw2;
+        const auto denominator = 1.0 + static_cast<double>(c[3]) * jw + static_cast<double>(c[4]) * jw2;
+
+        magnitude *= std::abs(numerator / denominator);
+    }
+
+    return magnitude;
+}
+
+template class BiquadCascade<float>;
+template class BiquadCascade<double>;
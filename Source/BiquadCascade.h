@@ -0,0 +1,145 @@
+#pragma once
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+
+//==============================================================================
+// Flat cascade of second-order sections. The coefficients of every section
+// live in one contiguous array, the state of every channel in another, and
+// process() only visits the sections that are switched on, in section order.
+//
+// Sections run the same transposed direct form II as juce::dsp::IIR::Filter
+// with the same order of operations, so the output matches an equivalent
+// chain of IIR::Filters bit-for-bit.
+//
+// When SIMD is available, channels are interleaved into the lanes of a
+// juce::dsp::SIMDRegister in batches as wide as the register (four floats
+// or two doubles with SSE/NEON) and filtered in one pass with shared
+// coefficients.
+// The lanes do exactly the per-channel arithmetic, so the vector path gives
+// the same output as the scalar one.
+//
+// A stereo cascade can give each channel its own coefficients: every section
+// stores a second set for the second channel (right, or side in mid/side
+// mode). In mid/side mode the encode/decode matrix is applied while
+// interleaving the two channels into the register lanes, so it costs no
+// extra pass over the buffer.
+//
+// Switching a section in or out is not instantaneous: its output is
+// crossfaded against its input over a few milliseconds, which covers the
+// start-up transient of a freshly cleared state and avoids clicks.
+template <typename SampleType>
+class BiquadCascade
+{
+public:
+    enum class ChannelMode
+    {
+        Shared,         // every channel uses the first coefficient set
+        Split,          // left uses the first set, right the second
+        MidSide         // as Split, on the mid and side signals
+    };
+
+    static constexpr int numCoefficientSets = 2;
+
+    BiquadCascade() = default;
+
+    // Allocates coefficient, state and interleaving storage; not real-time
+    // safe. Every section starts switched out, and sections switched in or
+    // out before the next process() call switch at once, without a fade, so
+    // a prepared design does not swell in from the dry signal.
+    void prepare(const juce::dsp::ProcessSpec& spec, int numSectionsToUse);
+    void reset();
+
+    // Rate the cascade runs at, which sets the length of the switching fades
+    // in samples. Does not allocate, so it can follow a change of
+    // oversampling factor on the audio thread.
+    void setSampleRate(double newSampleRate);
+
+    int getNumSections() const { return numSections; }
+    int getNumChannels() const { return numChannels; }
+
+    // Normalised b0, b1, b2, a1, a2 of a section, see CoefficientDesigner.
+    // The second set is only used outside ChannelMode::Shared.
+    SampleType* getCoefficients(int section, int set = 0);
+    const SampleType* getCoefficients(int section, int set = 0) const;
+
+    // Split and MidSide apply to stereo only; other channel counts behave as
+    // Shared. Entering or leaving MidSide carries the state across the
+    // mid/side matrix rather than clearing it.
+    void setChannelMode(ChannelMode newMode);
+    ChannelMode getChannelMode() const { return channelMode; }
+
+    // Inactive sections are skipped entirely once their fade-out is over. A
+    // section's state is cleared when it is switched back on from silence.
+    void setActive(int section, bool shouldBeActive);
+    bool isActive(int section) const;
+    int getNumProcessedSections() const { return numProcessed; }
+
+    // Takes over the coefficients, section switches and channel mode of a
+    // cascade with as many sections, without fades, and clears the state.
+    // Does not allocate, so a design prepared elsewhere can be loaded on the
+    // audio thread.
+    void loadDesign(const BiquadCascade& other);
+
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context);
+
+    // Samples for the impulse response of the active sections to decay below
+    // threshold, from their pole radii. Sums the per-section decay times, so
+    // it errs on the long side.
+    int getTailLengthSamples(double threshold) const;
+
+    // Largest absolute state value of the sections being processed
+    SampleType getStateMagnitude() const;
+
+    // Combined magnitude of the active sections (ignoring fades), for drawing
+    double getMagnitudeForFrequency(double frequency, double sampleRate, int set = 0) const;
+
+private:
+    static constexpr int stateSize = 2;
+    static constexpr double fadeSeconds = 0.005;
+
+    // Wet/dry ramp of a section being switched in or out
+    struct Fade
+    {
+        SampleType gain = 1;
+        SampleType step = 0;
+        int remaining = 0;
+
+        bool isRunning() const { return remaining > 0; }
+    };
+
+    int numSections = 0;
+    int numChannels = 0;
+    int maximumBlockSize = 0;
+    int fadeLength = 0;
+    bool hasProcessed = false;      // since prepare
+    ChannelMode channelMode = ChannelMode::Shared;
+
+    std::vector<SampleType> coefficients;   // [section][numCoefficientSets][biquadSize]
+    std::vector<SampleType> state;          // [channel][section][stateSize]
+
+    std::vector<char> activeFlags;
+    std::vector<Fade> fades;
+    std::vector<int> processedSections;     // active or fading sections, in order
+    int numProcessed = 0;
+
+    void clearState(int section);
+    void convertState(bool toMidSide);
+    void rebuildProcessedList();
+    void advanceFades(int numSamples);
+    void processScalar(SampleType* samples, int channel, int numSamples);
+
+    bool isStereoSplit() const { return channelMode != ChannelMode::Shared && numChannels == 2; }
+    bool isMidSide() const { return channelMode == ChannelMode::MidSide && numChannels == 2; }
+    int getCoefficientSet(int channel) const { return isStereoSplit() && channel == 1 ? 1 : 0; }
+
+   #if JUCE_USE_SIMD
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+
+    // Interleaved samples of the channels being processed together
+    std::vector<Vector> interleaved;
+
+    void processInterleaved(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, int numChannelsInBatch, int fadeOffset);
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadCascade)
+};
@@ -0,0 +1,344 @@
+#include "CoefficientDesigner.h"
+
+namespace CoefficientDesigner
+{
+    template <typename SampleType>
+    static void store(SampleType* coefficients, double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        const auto a0inv = 1.0 / a0;
+
+        coefficients[0] = static_cast<SampleType>(b0 * a0inv);
+        coefficients[1] = static_cast<SampleType>(b1 * a0inv);
+        coefficients[2] = static_cast<SampleType>(b2 * a0inv);
+        coefficients[3] = static_cast<SampleType>(a1 * a0inv);
+        coefficients[4] = static_cast<SampleType>(a2 * a0inv);
+    }
+
+    template <typename SampleType>
+    void makePeak(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(Q > 0.0);
+
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+        const auto alpha = std::sin(omega) / (Q * 2.0);
+        const auto c2 = -2.0 * std::cos(omega);
+        const auto alphaTimesA = alpha * A;
+        const auto alphaOverA = alpha / A;
+
+        store(coefficients, 1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                            1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+
+    PeakTerms getPeakTerms(double sampleRate, double frequency, double Q)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(Q > 0.0);
+
+        const auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+
+        return { std::sin(omega) / (Q * 2.0), -2.0 * std::cos(omega) };
+    }
+
+    template <typename SampleType>
+    void makePeak(SampleType* coefficients, const PeakTerms& terms, SampleType gainDb)
+    {
+        // A = 10^(gainDb / 40)
+        const auto A = juce::dsp::FastMathApproximations::exp(gainDb * static_cast<SampleType>(0.05756462732485115));
+        const auto alpha = static_cast<SampleType>(terms.alpha);
+        const auto c2 = static_cast<SampleType>(terms.c2);
+        const auto alphaTimesA = alpha * A;
+        const auto alphaOverA = alpha / A;
+        const auto a0inv = 1 / (1 + alphaOverA);
+
+        coefficients[0] = (1 + alphaTimesA) * a0inv;
+        coefficients[1] = c2 * a0inv;
+        coefficients[2] = (1 - alphaTimesA) * a0inv;
+        coefficients[3] = coefficients[1];
+        coefficients[4] = (1 - alphaOverA) * a0inv;
+    }
+
+    template <typename SampleType>
+    void makeLowPass(SampleType* coefficients, double sampleRate, double frequency, double Q)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+        jassert(Q > 0.0);
+
+        const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / Q;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        store(coefficients, c1, c1 * 2.0, c1,
+                            1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    template <typename SampleType>
+    void makeHighPass(SampleType* coefficients, double sampleRate, double frequency, double Q)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+        jassert(Q > 0.0);
+
+        const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / Q;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        store(coefficients, c1, c1 * -2.0, c1,
+                            1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    template <typename SampleType>
+    void makeLowShelf(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(Q > 0.0);
+
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto aminus1 = A - 1.0;
+        const auto aplus1 = A + 1.0;
+        const auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+        const auto coso = std::cos(omega);
+        const auto beta = std::sin(omega) * std::sqrt(A) / Q;
+        const auto aminus1TimesCoso = aminus1 * coso;
+
+        store(coefficients, A * (aplus1 - aminus1TimesCoso + beta),
+                            A * 2.0 * (aminus1 - aplus1 * coso),
+                            A * (aplus1 - aminus1TimesCoso - beta),
+                            aplus1 + aminus1TimesCoso + beta,
+                            -2.0 * (aminus1 + aplus1 * coso),
+                            aplus1 + aminus1TimesCoso - beta);
+    }
+
+    template <typename SampleType>
+    void makeHighShelf(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(Q > 0.0);
+
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto aminus1 = A - 1.0;
+        const auto aplus1 = A + 1.0;
+        const auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+        const auto coso = std::cos(omega);
+        const auto beta = std::sin(omega) * std::sqrt(A) / Q;
+        const auto aminus1TimesCoso = aminus1 * coso;
+
+        store(coefficients, A * (aplus1 + aminus1TimesCoso + beta),
+                            A * -2.0 * (aminus1 + aplus1 * coso),
+                            A * (aplus1 + aminus1TimesCoso - beta),
+                            aplus1 - aminus1TimesCoso + beta,
+                            2.0 * (aminus1 - aplus1 * coso),
+                            aplus1 - aminus1TimesCoso - beta);
+    }
+
+    template <typename SampleType>
+    void makeNotch(SampleType* coefficients, double sampleRate, double frequency, double Q)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+        jassert(Q > 0.0);
+
+        const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / Q;
+        const auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+        const auto b0 = c1 * (1.0 + nSquared);
+        const auto b1 = 2.0 * c1 * (1.0 - nSquared);
+
+        store(coefficients, b0, b1, b0,
+                            1.0, b1, c1 * (1.0 - n * invQ + nSquared));
+    }
+
+    template <typename SampleType>
+    void makeBandPass(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+        jassert(Q > 0.0);
+
+        const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / Q;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+        const auto b0 = c1 * n * invQ * gainFactor;
+
+        store(coefficients, b0, 0.0, -b0,
+                            1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    template <typename SampleType>
+    void makeTilt(SampleType* coefficients, double sampleRate, double frequency, double gainFactor)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+
+        // Prototype (A s + 1) / (s + A): 1 / A at DC, A at infinity and unity
+        // at s = j, bilinear transformed with the pivot prewarped
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto K = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+
+        store(coefficients, A * K + 1.0, 1.0 - A * K, 0.0,
+                            K + A, A - K, 0.0);
+    }
+
+    // a1, a2 of the poles of s^2 + s/Q + 1 at w0, mapped with z = e^(sT)
+    static void getMatchedPoles(double w0, double Q, double& a1, double& a2)
+    {
+        const auto zeta = 1.0 / (2.0 * Q);
+        const auto decay = std::exp(-zeta * w0);
+
+        if (zeta <= 1.0)
+            a1 = -2.0 * decay * std::cos(std::sqrt(1.0 - zeta * zeta) * w0);
+        else
+            a1 = -2.0 * decay * std::cosh(std::sqrt(zeta * zeta - 1.0) * w0);
+
+        a2 = decay * decay;
+    }
+
+    // Matched boost (G >= 1) with the analog prototype
+    // (s^2 + s A/Q + 1) / (s^2 + s / (A Q) + 1), A = sqrt(G)
+    static void designMatchedBoost(double w0, double Q, double G, double* b, double* a)
+    {
+        getMatchedPoles(w0, Q * std::sqrt(G), a[1], a[2]);
+        a[0] = 1.0;
+
+        // Squared magnitudes are linear in these terms of sin^2(w/2)
+        const auto A0 = juce::square(1.0 + a[1] + a[2]);
+        const auto A1 = juce::square(1.0 - a[1] + a[2]);
+        const auto A2 = -4.0 * a[2];
+
+        const auto phi1 = juce::square(std::sin(w0 * 0.5));
+        const auto phi0 = 1.0 - phi1;
+        const auto phi2 = 4.0 * phi0 * phi1;
+
+        // Analog squared magnitude at Nyquist, in units of w0
+        const auto nyquistSquared = juce::square(juce::MathConstants<double>::pi / w0);
+        const auto nyquistMagnitudeSquared = (juce::square(1.0 - nyquistSquared) + nyquistSquared * G / (Q * Q))
+                                           / (juce::square(1.0 - nyquistSquared) + nyquistSquared / (G * Q * Q));
+
+        // Match unity at DC, the prototype at Nyquist and G at w0
+        const auto B0 = A0;
+        const auto B1 = A1 * nyquistMagnitudeSquared;
+        const auto B2 = (G * G * (A0 * phi0 + A1 * phi1 + A2 * phi2) - B0 * phi0 - B1 * phi1) / phi2;
+
+        // The larger root for b0 keeps the zeros inside the unit circle
+        const auto rootB0 = std::sqrt(B0);
+        const auto rootB1 = std::sqrt(B1);
+        const auto W = 0.5 * (rootB0 + rootB1);
+
+        b[0] = 0.5 * (W + std::sqrt(juce::jmax(0.0, W * W + B2)));
+        b[1] = 0.5 * (rootB0 - rootB1);
+        b[2] = -B2 / (4.0 * b[0]);
+    }
+
+    template <typename SampleType>
+    void makeMatchedPeak(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(Q > 0.0);
+
+        const auto G = juce::jmax(gainFactor, 1.0e-6);
+        const auto w0 = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+
+        double b[3], a[3];
+
+        // A cut is the inverse of the boost by the same amount, as in the
+        // analog prototype. Inverting the matched boost tracks the prototype
+        // more closely than matching the cut directly, whose zeros are not
+        // impulse invariant.
+        if (G >= 1.0) {
+            designMatchedBoost(w0, Q, G, b, a);
+            store(coefficients, b[0], b[1], b[2], a[0], a[1], a[2]);
+        }
+        else {
+            designMatchedBoost(w0, Q, 1.0 / G, b, a);
+            store(coefficients, a[0], a[1], a[2], b[0], b[1], b[2]);
+        }
+    }
+
+    template <typename SampleType>
+    void makeMatchedLowPass(SampleType* coefficients, double sampleRate, double frequency, double Q)
+    {
+        jassert(sampleRate > 0.0);
+        jassert(frequency > 0.0 && frequency <= sampleRate * 0.5);
+        jassert(Q > 0.0);
+
+        const auto w0 = (juce::MathConstants<double>::twoPi * frequency) / sampleRate;
+
+        double a1, a2;
+        getMatchedPoles(w0, Q, a1, a2);
+
+        // Analog magnitude at Nyquist, f0 being the cutoff relative to Nyquist
+        const auto f0 = w0 / juce::MathConstants<double>::pi;
+        const auto f0Squared = f0 * f0;
+
+        const auto r0 = 1.0 + a1 + a2;
+        const auto r1 = (1.0 - a1 + a2) * f0Squared / std::sqrt(juce::square(1.0 - f0Squared) + f0Squared / (Q * Q));
+
+        const auto b0 = 0.5 * (r0 + r1);
+
+        store(coefficients, b0, r0 - b0, 0.0, 1.0, a1, a2);
+    }
+
+    template <typename SampleType>
+    void makeIdentity(SampleType* coefficients)
+    {
+        store(coefficients, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+    }
+
+    double getButterworthQ(int order, int section)
+    {
+        jassert(order > 1);
+        jassert(section >= 0 && section < order / 2);
+
+        // Pole pairs sit at odd multiples of pi / (2 order) from the negative
+        // real axis for even orders and at even multiples for odd orders
+        const auto multiple = 2.0 * section + 1.0 + (order % 2);
+
+        return 1.0 / (2.0 * std::cos(multiple * juce::MathConstants<double>::pi / (order * 2.0)));
+    }
+
+    double getLinkwitzRileyQ(int order, int section)
+    {
+        jassert(order > 0 && order % 2 == 0);
+        jassert(section >= 0 && section < order / 2);
+
+        const auto butterworthOrder = order / 2;
+        const auto numPairedSections = (butterworthOrder / 2) * 2;
+
+        if (section < numPairedSections)
+            return getButterworthQ(butterworthOrder, section / 2);
+
+        return 0.5;
+    }
+
+    template void makePeak<float>(float*, double, double, double, double);
+    template void makePeak<float>(float*, const PeakTerms&, float);
+    template void makeLowPass<float>(float*, double, double, double);
+    template void makeHighPass<float>(float*, double, double, double);
+    template void makeLowShelf<float>(float*, double, double, double, double);
+    template void makeHighShelf<float>(float*, double, double, double, double);
+    template void makeNotch<float>(float*, double, double, double);
+    template void makeBandPass<float>(float*, double, double, double, double);
+    template void makeTilt<float>(float*, double, double, double);
+    template void makeMatchedPeak<float>(float*, double, double, double, double);
+    template void makeMatchedLowPass<float>(float*, double, double, double);
+    template void makeIdentity<float>(float*);
+
+    template void makePeak<double>(double*, double, double, double, double);
+    template void makePeak<double>(double*, const PeakTerms&, double);
+    template void makeLowPass<double>(double*, double, double, double);
+    template void makeHighPass<double>(double*, double, double, double);
+    template void makeLowShelf<double>(double*, double, double, double, double);
+    template void makeHighShelf<double>(double*, double, double, double, double);
+    template void makeNotch<double>(double*, double, double, double);
+    template void makeBandPass<double>(double*, double, double, double, double);
+    template void makeTilt<double>(double*, double, double, double);
+    template void makeMatchedPeak<double>(double*, double, double, double, double);
+    template void makeMatchedLowPass<double>(double*, double, double, double);
+    template void makeIdentity<double>(double*);
+}
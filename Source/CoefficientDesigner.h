@@ -0,0 +1,83 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Allocation-free biquad design. Every function writes the normalised
+// coefficients of one second-order section (b0, b1, b2, a1, a2 - the same
+// layout juce::dsp::IIR::Coefficients uses) into storage owned by the caller,
+// so it is safe to call from the audio thread.
+// The maths follows IIR::Coefficients and FilterDesign, evaluated in double
+// precision before rounding to the storage type.
+namespace CoefficientDesigner
+{
+    constexpr int biquadSize = 5;
+
+    // RBJ peaking EQ
+    template <typename SampleType>
+    void makePeak(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor);
+
+    // makePeak split in two for gains that move every control block: the
+    // terms that depend on frequency and Q, computed when those change, and
+    // a gain step that only needs FastMathApproximations::exp and a divide.
+    // Matches makePeak to within a few thousandths of a dB from -42 to
+    // +24 dB, the range a dynamic band can reach.
+    struct PeakTerms
+    {
+        double alpha = 0.0;
+        double c2 = -2.0;
+    };
+
+    PeakTerms getPeakTerms(double sampleRate, double frequency, double Q);
+
+    template <typename SampleType>
+    void makePeak(SampleType* coefficients, const PeakTerms& terms, SampleType gainDb);
+
+    template <typename SampleType>
+    void makeLowPass(SampleType* coefficients, double sampleRate, double frequency, double Q);
+
+    template <typename SampleType>
+    void makeHighPass(SampleType* coefficients, double sampleRate, double frequency, double Q);
+
+    // RBJ shelves, with the gain reached below (low) or above (high) frequency
+    template <typename SampleType>
+    void makeLowShelf(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor);
+
+    template <typename SampleType>
+    void makeHighShelf(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor);
+
+    template <typename SampleType>
+    void makeNotch(SampleType* coefficients, double sampleRate, double frequency, double Q);
+
+    // RBJ band-pass with a peak gain of gainFactor at frequency
+    template <typename SampleType>
+    void makeBandPass(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor);
+
+    // First-order tilt pivoting around frequency: half the gain (in dB) above
+    // it and the opposite below, with unity gain at the pivot. b2 = a2 = 0.
+    template <typename SampleType>
+    void makeTilt(SampleType* coefficients, double sampleRate, double frequency, double gainFactor);
+
+    // Matched designs after Vicanek, "Matched Second Order Digital Filters":
+    // impulse-invariant poles, with zeros chosen so the magnitude equals the
+    // analog prototype's at DC, at Nyquist and (for the peak) at the centre
+    // frequency. No bilinear frequency warping, at the same per-sample cost.
+    template <typename SampleType>
+    void makeMatchedPeak(SampleType* coefficients, double sampleRate, double frequency, double Q, double gainFactor);
+
+    template <typename SampleType>
+    void makeMatchedLowPass(SampleType* coefficients, double sampleRate, double frequency, double Q);
+
+    // Pass-through section
+    template <typename SampleType>
+    void makeIdentity(SampleType* coefficients);
+
+    // Q of the given second-order section of a Butterworth filter. Odd orders
+    // have order / 2 such sections plus a first-order one, not covered here.
+    double getButterworthQ(int order, int section);
+
+    // Q of the given section of an even-order Linkwitz-Riley filter, built as
+    // a Butterworth of half the order applied twice. Needs order / 2
+    // sections; with an odd Butterworth order, the two first-order sections
+    // pair up into the last one, at Q 0.5.
+    double getLinkwitzRileyQ(int order, int section);
+}
@@ -3,13 +3,16 @@
 CutFilterSection::CutFilterSection(juce::AudioProcessorValueTreeState& apvts,
     const juce::String& freqParamId,
     const juce::String& slopeParamId,
+    const juce::String& typeParamId,
     const juce::String& bypassParamId,
     const juce::StringArray& slopeLabels,
+    const juce::StringArray& typeLabels,
     const juce::String& title,
     juce::Colour accentColour)
     : SectionPanel(apvts, bypassParamId, title, accentColour),
     freqSlider(*apvts.getParameter(freqParamId), "Hz", "FREQ"),
     slopeCombo(slopeParamId, "dB/Oct", "SLOPE", accentColour),
+    typeCombo(typeParamId, "", "TYPE", accentColour),
     freqAttachment(apvts, freqParamId, freqSlider)
 {
     for (int i = 0; i < slopeLabels.size(); ++i)
@@ -17,14 +20,20 @@ CutFilterSection::CutFilterSection(juce::AudioProcessorValueTreeState& apvts,
 
     slopeAttachment = std::make_unique<ComboBoxAttachment>(apvts, slopeParamId, slopeCombo);
 
+    for (int i = 0; i < typeLabels.size(); ++i)
+        typeCombo.addItem(typeLabels[i], i + 1);
+
+    typeAttachment = std::make_unique<ComboBoxAttachment>(apvts, typeParamId, typeCombo);
+
     addAndMakeVisible(freqSlider);
     addAndMakeVisible(slopeCombo);
+    addAndMakeVisible(typeCombo);
 }
 
 void CutFilterSection::layoutControls(juce::Rectangle<int> area)
 {
     static constexpr float GapRatio = 0.12f;
-    static constexpr float SliderRatio = 0.75f;
+    static constexpr float SliderRatio = 0.65f;
 
     const int gap = static_cast<int>(area.getHeight() * GapRatio);
     area.removeFromTop(gap);
@@ -32,5 +41,6 @@ void CutFilterSection::layoutControls(juce::Rectangle<int> area)
 
     freqSlider.setBounds(area.removeFromTop(static_cast<int>(area.getHeight() * SliderRatio)));
     area.removeFromTop(3);
-    slopeCombo.setBounds(area);
+    slopeCombo.setBounds(area.removeFromTop(area.getHeight() / 2));
+    typeCombo.setBounds(area);
 }
\ No newline at end of file
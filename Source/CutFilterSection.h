@@ -9,19 +9,23 @@ public:
     CutFilterSection(juce::AudioProcessorValueTreeState& apvts,
         const juce::String& freqParamId,
         const juce::String& slopeParamId,
+        const juce::String& typeParamId,
         const juce::String& bypassParamId,
         const juce::StringArray& slopeLabels,
+        const juce::StringArray& typeLabels,
         const juce::String& title,
         juce::Colour accentColour);
 
 protected:
     CustomRotarySlider freqSlider;
     MinimalCombo slopeCombo;
+    MinimalCombo typeCombo;
 
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
     SliderAttachment                    freqAttachment;
     std::unique_ptr<ComboBoxAttachment> slopeAttachment;
+    std::unique_ptr<ComboBoxAttachment> typeAttachment;
 
     void layoutControls(juce::Rectangle<int> area) override;
 };
\ No newline at end of file
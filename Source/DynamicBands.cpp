@@ -0,0 +1,253 @@
+#include "DynamicBands.h"
+
+template <typename SampleType>
+void DynamicBands<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, int numBandsToUse)
+{
+    jassert(numBandsToUse >= 0);
+
+    numBands = numBandsToUse;
+    sampleRate = spec.sampleRate;
+
+    bands.assign(static_cast<size_t>(numBands), Band());
+    activeList.clear();
+    activeList.reserve(static_cast<size_t>(numBands));
+    detectorSignal.resize(static_cast<size_t>(spec.maximumBlockSize));
+    numActive = 0;
+    activeListDirty = false;
+
+    reset();
+}
+
+template <typename SampleType>
+void DynamicBands<SampleType>::reset()
+{
+    for (auto& band : bands)
+    {
+        std::fill(std::begin(band.state), std::end(band.state), SampleType(0));
+        band.envelope = 0;
+        band.reductionDb = 0;
+    }
+}
+
+template <typename SampleType>
+void DynamicBands<SampleType>::setBand(int band, bool shouldBeActive, float frequency, float Q, float gainDb,
+                                       const BandDynamics& dynamics, double designSampleRate)
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+
+    auto& b = bands[static_cast<size_t>(band)];
+
+    if (b.active != shouldBeActive)
+    {
+        std::fill(std::begin(b.state), std::end(b.state), SampleType(0));
+        b.envelope = 0;
+        b.reductionDb = 0;
+
+        b.active = shouldBeActive;
+        numActive += shouldBeActive ? 1 : -1;
+        activeListDirty = true;
+    }
+
+    if (!shouldBeActive)
+        return;
+
+    // Called every control block: the transcendental parts are only redone
+    // when their inputs move
+    if (frequency != b.designedFrequency || Q != b.designedQ || designSampleRate != b.designedSampleRate)
+    {
+        b.detector = StateVariableFilter::makeCoefficients(StateVariableFilter::Type::BandPass,
+            static_cast<SampleType>(frequency / sampleRate), static_cast<SampleType>(Q), SampleType(0));
+        b.peakTerms = CoefficientDesigner::getPeakTerms(designSampleRate, frequency, Q);
+
+        b.designedFrequency = frequency;
+        b.designedQ = Q;
+        b.designedSampleRate = designSampleRate;
+    }
+
+    if (dynamics.attack != b.attackMs)
+    {
+        b.attackGain = static_cast<SampleType>(1.0 - std::exp(-1000.0 / (juce::jmax(0.01f, dynamics.attack) * sampleRate)));
+        b.attackMs = dynamics.attack;
+    }
+
+    if (dynamics.release != b.releaseMs)
+    {
+        b.releaseGain = static_cast<SampleType>(1.0 - std::exp(-1000.0 / (juce::jmax(0.01f, dynamics.release) * sampleRate)));
+        b.releaseMs = dynamics.release;
+    }
+
+    b.threshold = static_cast<SampleType>(dynamics.threshold);
+    b.slope = static_cast<SampleType>(1.0f - 1.0f / juce::jmax(1.0f, dynamics.ratio));
+    b.gainDb = static_cast<SampleType>(gainDb);
+}
+
+template <typename SampleType>
+bool DynamicBands<SampleType>::isActive(int band) const
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+    return bands[static_cast<size_t>(band)].active;
+}
+
+template <typename SampleType>
+void DynamicBands<SampleType>::rebuildActiveList()
+{
+    activeList.clear();
+
+    for (int band = 0; band < numBands; ++band)
+        if (bands[static_cast<size_t>(band)].active)
+            activeList.push_back(band);
+
+    activeListDirty = false;
+}
+
+template <typename SampleType>
+void DynamicBands<SampleType>::detectScalar(Band& band, int numSamples)
+{
+    auto envelope = band.envelope;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto level = std::abs(StateVariableFilter::processSample(band.detector, band.state, detectorSignal[static_cast<size_t>(i)]));
+        const auto delta = level - envelope;
+
+        envelope += juce::jmax(delta, SampleType(0)) * band.attackGain
+                  + juce::jmin(delta, SampleType(0)) * band.releaseGain;
+    }
+
+    band.envelope = envelope;
+}
+
+#if JUCE_USE_SIMD
+template <typename SampleType>
+void DynamicBands<SampleType>::detectInterleaved(const int* bandIndices, int numBandsInBatch, int numSamples)
+{
+    jassert(numBandsInBatch <= static_cast<int>(Vector::size()));
+
+    // Unused lanes have zero gains throughout and stay silent
+    auto zero = Vector::expand(SampleType(0));
+    auto a1 = zero, a2 = zero, a3 = zero, m1 = zero;
+    auto s1 = zero, s2 = zero, envelope = zero;
+    auto attackGain = zero, releaseGain = zero;
+
+    for (int lane = 0; lane < numBandsInBatch; ++lane)
+    {
+        const auto& b = bands[static_cast<size_t>(bandIndices[lane])];
+        const auto l = static_cast<size_t>(lane);
+
+        a1.set(l, b.detector.a1);
+        a2.set(l, b.detector.a2);
+        a3.set(l, b.detector.a3);
+        m1.set(l, b.detector.m1);
+        s1.set(l, b.state[0]);
+        s2.set(l, b.state[1]);
+        envelope.set(l, b.envelope);
+        attackGain.set(l, b.attackGain);
+        releaseGain.set(l, b.releaseGain);
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto input = Vector::expand(detectorSignal[static_cast<size_t>(i)]);
+
+        const auto v3 = input - s2;
+        const auto v1 = a1 * s1 + a2 * v3;
+        const auto v2 = s2 + a2 * s1 + a3 * v3;
+
+        s1 = v1 + v1 - s1;
+        s2 = v2 + v2 - s2;
+
+        const auto level = Vector::abs(m1 * v1);
+        const auto delta = level - envelope;
+
+        envelope += Vector::max(delta, zero) * attackGain + Vector::min(delta, zero) * releaseGain;
+    }
+
+    for (int lane = 0; lane < numBandsInBatch; ++lane)
+    {
+        auto& b = bands[static_cast<size_t>(bandIndices[lane])];
+        const auto l = static_cast<size_t>(lane);
+
+        b.state[0] = s1.get(l);
+        b.state[1] = s2.get(l);
+        b.envelope = envelope.get(l);
+    }
+}
+#endif
+
+template <typename SampleType>
+void DynamicBands<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& detectorBlock)
+{
+    if (numActive == 0)
+        return;
+
+    if (activeListDirty)
+        rebuildActiveList();
+
+    const auto numChannels = detectorBlock.getNumChannels();
+    const auto numSamples = static_cast<int>(detectorBlock.getNumSamples());
+    const auto maximumBlockSize = static_cast<int>(detectorSignal.size());
+
+    if (numChannels == 0)
+        return;
+
+    const auto channelScale = SampleType(1) / static_cast<SampleType>(numChannels);
+
+    for (int start = 0; start < numSamples; start += maximumBlockSize)
+    {
+        const auto length = juce::jmin(maximumBlockSize, numSamples - start);
+
+        for (int i = 0; i < length; ++i)
+        {
+            SampleType sum = 0;
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                sum += detectorBlock.getChannelPointer(channel)[start + i];
+
+            detectorSignal[static_cast<size_t>(i)] = sum * channelScale;
+        }
+
+        int index = 0;
+        const auto numListed = static_cast<int>(activeList.size());
+
+       #if JUCE_USE_SIMD
+        // A single leftover band takes the scalar path
+        constexpr auto lanes = static_cast<int>(Vector::size());
+
+        for (; numListed - index >= 2; index += lanes)
+            detectInterleaved(activeList.data() + index, juce::jmin(lanes, numListed - index), length);
+       #endif
+
+        for (; index < numListed; ++index)
+            detectScalar(bands[static_cast<size_t>(activeList[static_cast<size_t>(index)])], length);
+    }
+
+    for (const auto band : activeList)
+    {
+        auto& b = bands[static_cast<size_t>(band)];
+
+        juce::dsp::util::snapToZero(b.state[0]);
+        juce::dsp::util::snapToZero(b.state[1]);
+
+        const auto levelDb = juce::Decibels::gainToDecibels(b.envelope, SampleType(-120));
+        b.reductionDb = juce::jlimit(SampleType(0), maxReductionDb, (levelDb - b.threshold) * b.slope);
+    }
+}
+
+template <typename SampleType>
+void DynamicBands<SampleType>::designSection(int band, SampleType* coefficients) const
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+
+    const auto& b = bands[static_cast<size_t>(band)];
+    CoefficientDesigner::makePeak(coefficients, b.peakTerms, b.gainDb - b.reductionDb);
+}
+
+template <typename SampleType>
+SampleType DynamicBands<SampleType>::getGainReductionDb(int band) const
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+    return bands[static_cast<size_t>(band)].reductionDb;
+}
+
+template class DynamicBands<float>;
+template class DynamicBands<double>;
@@ -0,0 +1,100 @@
+#pragma once
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+#include "StateVariableFilter.h"
+
+//==============================================================================
+// Dynamics of one bell band: above the threshold, the level in the band is
+// compressed by ratio, pulling the band's gain down from its static value
+struct BandDynamics
+{
+    bool enabled = false;
+    float threshold = -24.0f;       // dB
+    float ratio = 2.0f;
+    float attack = 5.0f;            // ms
+    float release = 120.0f;         // ms
+};
+
+//==============================================================================
+// Detectors and gain computers of the dynamic bands. The bands themselves
+// stay in the BiquadCascade: once per control block the processor runs the
+// detectors over the block about to be filtered and asks for each band's
+// coefficients at its current gain, designed through the cheap
+// CoefficientDesigner::makePeak overload.
+//
+// The detector signal is the mean of the detector block's channels, so each
+// band runs one band-pass regardless of the channel count. The band-passes
+// and envelope followers of several bands share one pass over the block,
+// one band per SIMD lane, with branch-free attack/release selection.
+template <typename SampleType>
+class DynamicBands
+{
+public:
+    DynamicBands() = default;
+
+    // Allocates the detector buffer and per-band state; not real-time safe
+    void prepare(const juce::dsp::ProcessSpec& spec, int numBandsToUse);
+    void reset();
+
+    // Bands that are not active are skipped by the detectors and have their
+    // envelope cleared. designSampleRate is the rate of the cascade the
+    // coefficients are for, which differs from the detector's when
+    // oversampling.
+    void setBand(int band, bool shouldBeActive, float frequency, float Q, float gainDb,
+                 const BandDynamics& dynamics, double designSampleRate);
+
+    bool isActive(int band) const;
+    bool isProcessing() const { return numActive > 0; }
+
+    // Runs the detectors over the block and updates every active band's gain
+    void process(const juce::dsp::AudioBlock<SampleType>& detectorBlock);
+
+    // Writes the band's biquad at its static gain less the current reduction
+    void designSection(int band, SampleType* coefficients) const;
+
+    // Current gain reduction of a band, in positive dB
+    SampleType getGainReductionDb(int band) const;
+
+private:
+    static constexpr SampleType maxReductionDb = 30;
+
+    struct Band
+    {
+        bool active = false;
+
+        // Band-pass detector, unity gain at the centre
+        StateVariableFilter::Coefficients<SampleType> detector;
+        SampleType state[StateVariableFilter::stateSize] = { 0, 0 };
+
+        // One-pole envelope, with attack and release as 1 - pole
+        SampleType envelope = 0;
+        SampleType attackGain = 0, releaseGain = 0;
+        float attackMs = 0.0f, releaseMs = 0.0f;
+
+        SampleType threshold = 0, slope = 0;
+        SampleType gainDb = 0, reductionDb = 0;
+
+        CoefficientDesigner::PeakTerms peakTerms;
+        double designedFrequency = 0.0, designedQ = 0.0, designedSampleRate = 0.0;
+    };
+
+    int numBands = 0;
+    int numActive = 0;
+    bool activeListDirty = false;
+    double sampleRate = 44100.0;
+
+    std::vector<Band> bands;
+    std::vector<int> activeList;
+    std::vector<SampleType> detectorSignal;
+
+    void rebuildActiveList();
+    void detectScalar(Band& band, int numSamples);
+
+   #if JUCE_USE_SIMD
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+
+    void detectInterleaved(const int* bandIndices, int numBandsInBatch, int numSamples);
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynamicBands)
+};
@@ -1,147 +1,571 @@
 #include "FFTAnalyzer.h"
 
-FFTPathProducer::FFTPathProducer(SampleFifo& fifoToUse)
+namespace
+{
+    constexpr float minFreq = 20.0f;
+    constexpr float maxFreq = 20000.0f;
+    constexpr float negInfDB = -96.0f;   // true silence floor for gainToDecibels
+    constexpr float minDB = -48.0f;    // display bottom (wide range for analyzer)
+    constexpr float maxDB = 6.0f;      // display top
+    constexpr float visualBoostDB = 12.0f;     // brings broadband music into visible range
+
+    // Exponent from the float's bits plus a series for the mantissa's log,
+    // within 0.001 dB of gainToDecibels. Branch-free, so the loop using it
+    // vectorises.
+    inline float fastLog2(float x)
+    {
+        juce::int32 bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+
+        const auto exponent = static_cast<float>(((bits >> 23) & 255) - 127);
+        bits = (bits & 0x007fffff) | 0x3f800000;
+
+        float mantissa;
+        std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+        // log2(m) = 2 / ln 2 * (t + t^3 / 3 + t^5 / 5 + t^7 / 7 ...), t = (m - 1) / (m + 1)
+        const auto t = (mantissa - 1.0f) / (mantissa + 1.0f);
+        const auto t2 = t * t;
+
+        return exponent + t * (2.8853901f + t2 * (0.96179669f + t2 * (0.57707802f + t2 * 0.41219858f)));
+    }
+
+    // Magnitudes to display dB in place, boosted and clamped to the display range
+    void magnitudesToDisplayDecibels(float* values, int numValues)
+    {
+        constexpr float decibelsPerOctave = 6.0205999f;
+        const auto floorGain = juce::Decibels::decibelsToGain(negInfDB);
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            const auto dB = fastLog2(juce::jmax(values[i], floorGain)) * decibelsPerOctave + visualBoostDB;
+            values[i] = juce::jlimit(minDB, maxDB, dB);
+        }
+    }
+
+    // Mean over x - halfWidth to x + halfWidth, shrinking at the edges, from a
+    // running sum
+    void movingAverage(const float* source, float* destination, int numValues, int halfWidth)
+    {
+        double sum = 0.0;
+        int lo = 0, hi = juce::jmin(numValues - 1, halfWidth);
+
+        for (int k = lo; k <= hi; ++k)
+            sum += source[k];
+
+        for (int x = 0; x < numValues; ++x)
+        {
+            destination[x] = static_cast<float>(sum / (hi - lo + 1));
+
+            if (x + halfWidth + 1 < numValues)
+                sum += source[++hi];
+
+            if (x - halfWidth >= 0)
+                sum -= source[lo++];
+        }
+    }
+}
+
+SampleFifo::SampleFifo()
+{
+    std::array<float, halfBandLength> window;
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+        juce::dsp::WindowingFunction<float>::kaiser, false, halfBandKaiserBeta);
+
+    // Odd taps of sin(pi n / 2) / (pi n), windowed
+    double sum = 0.0;
+
+    for (int pair = 0; pair < numHalfBandPairs; ++pair)
+    {
+        const auto offset = 2 * pair + 1;
+        const auto sinc = std::sin(juce::MathConstants<double>::halfPi * offset) / (juce::MathConstants<double>::pi * offset);
+
+        halfBandCoefficients[static_cast<size_t>(pair)] = static_cast<float>(sinc) * window[static_cast<size_t>(halfBandCentre + offset)];
+        sum += halfBandCoefficients[static_cast<size_t>(pair)];
+    }
+
+    // With the centre tap at a half, pairs summing to a half pass DC at unity
+    for (auto& coefficient : halfBandCoefficients)
+        coefficient = static_cast<float>(coefficient * 0.25 / sum);
+}
+
+void SampleFifo::attachConsumer()
+{
+    // Never freed, so a push racing a detach still writes to valid memory
+    if (storage == nullptr)
+        storage.allocate(capacity, true);
+
+    numConsumers.fetch_add(1, std::memory_order_release);
+}
+
+void SampleFifo::detachConsumer()
+{
+    jassert(numConsumers.load() > 0);
+    numConsumers.fetch_sub(1, std::memory_order_release);
+}
+
+int SampleFifo::getDecimationFor(double sampleRate)
+{
+    int factor = 1;
+
+    while (factor < maxDecimation && sampleRate / (factor * 2) >= minAnalyzedSampleRate)
+        factor *= 2;
+
+    return factor;
+}
+
+void SampleFifo::setDecimation(int factor)
+{
+    jassert(juce::isPowerOfTwo(factor) && juce::isPositiveAndNotGreaterThan(factor, maxDecimation));
+
+    decimation.store(juce::jlimit(1, maxDecimation, juce::nextPowerOfTwo(factor)));
+}
+
+void SampleFifo::resetDecimator(int factor)
+{
+    for (auto& halfBand : halfBands)
+    {
+        std::fill(halfBand.history.begin(), halfBand.history.end(), 0.0f);
+        halfBand.index = 0;
+        halfBand.isOddSample = false;
+    }
+
+    appliedDecimation = factor;
+    decimationCount = 0;
+}
+
+bool SampleFifo::decimateSample(float& sample, int numStages)
+{
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        auto& halfBand = halfBands[static_cast<size_t>(stage)];
+
+        halfBand.index = (halfBand.index == 0 ? halfBandLength : halfBand.index) - 1;
+        halfBand.history[static_cast<size_t>(halfBand.index)] = sample;
+        halfBand.history[static_cast<size_t>(halfBand.index + halfBandLength)] = sample;
+
+        // Only every second output is kept, so only those are computed
+        halfBand.isOddSample = !halfBand.isOddSample;
+
+        if (halfBand.isOddSample)
+            return false;
+
+        const auto* x = halfBand.history.data() + halfBand.index;
+        auto output = 0.5f * x[halfBandCentre];
+
+        for (int pair = 0; pair < numHalfBandPairs; ++pair)
+        {
+            const auto offset = 2 * pair + 1;
+            output += halfBandCoefficients[static_cast<size_t>(pair)] * (x[halfBandCentre - offset] + x[halfBandCentre + offset]);
+        }
+
+        sample = output;
+    }
+
+    return true;
+}
+
+SampleFifo::ReadSpans SampleFifo::prepareRead() const
+{
+    if (storage == nullptr)
+        return {};
+
+    int start1, size1, start2, size2;
+    abstractFifo.prepareToRead(getNumReady(), start1, size1, start2, size2);
+
+    return { storage.get() + start1, size1, storage.get() + start2, size2 };
+}
+
+//==============================================================================
+
+FFTPathProducer::FFTPathProducer(SampleFifo& fifoToUse, bool useSharedThread)
     : sampleFifo(fifoToUse)
 {
-    smoothedMagnitudes.fill(0.0f);
+    prepareStages(appliedSettings);
+
+    if (useSharedThread)
+    {
+        service = std::make_unique<juce::SharedResourcePointer<AnalyzerService>>();
+        (*service)->addProducer(*this);
+    }
 }
 
-void FFTPathProducer::process(juce::Rectangle<float> bounds, double sampleRate)
+FFTPathProducer::~FFTPathProducer()
 {
-    if (bounds.getWidth() <= 0 || bounds.getHeight() <= 0 || sampleRate <= 0)
+    // Waits for the worker to finish with this producer
+    if (service != nullptr)
+        (*service)->removeProducer(*this);
+
+    if (attached)
+        sampleFifo.detachConsumer();
+}
+
+void FFTPathProducer::setTarget(juce::Rectangle<float> bounds, double sampleRate, bool shouldBeEnabled)
+{
+    // The audio thread only feeds the FIFO while it is attached
+    if (shouldBeEnabled != attached)
+    {
+        if (shouldBeEnabled)
+            sampleFifo.attachConsumer();
+        else
+            sampleFifo.detachConsumer();
+
+        attached = shouldBeEnabled;
+    }
+
+    const juce::SpinLock::ScopedLockType lock(targetLock);
+    targetBounds = bounds;
+    targetSampleRate = sampleRate;
+    enabled = shouldBeEnabled;
+}
+
+void FFTPathProducer::setSettings(const AnalyzerSettings& newSettings)
+{
+    const juce::SpinLock::ScopedLockType lock(targetLock);
+    targetSettings = newSettings;
+}
+
+bool FFTPathProducer::fetchLatestPath()
+{
+    if ((readyPath.load() & freshPathFlag) == 0)
+        return false;
+
+    frontPath = readyPath.exchange(frontPath) & ~freshPathFlag;
+    return true;
+}
+
+void FFTPathProducer::publishPath()
+{
+    backPath = readyPath.exchange(backPath | freshPathFlag) & ~freshPathFlag;
+}
+
+void FFTPathProducer::update()
+{
+    juce::Rectangle<float> bounds;
+    double sampleRate;
+    bool isEnabled;
+    AnalyzerSettings settings;
+
     {
+        const juce::SpinLock::ScopedLockType lock(targetLock);
+        bounds = targetBounds;
+        sampleRate = targetSampleRate;
+        isEnabled = enabled;
+        settings = targetSettings;
+    }
+
+    if (settings != appliedSettings)
+        prepareStages(settings);
+
+    if (isEnabled)
+        process(bounds, sampleRate);
+    else
         drain();
-        return;
+}
+
+void FFTPathProducer::prepareStages(const AnalyzerSettings& settings)
+{
+    const auto order = juce::jlimit(minAnalyzerFFTOrder, maxAnalyzerFFTOrder, settings.fftOrder);
+
+    stages[0].prepare(order, settings.hopSize);
+    numStages = 1;
+
+    if (settings.multiResolution && order < maxAnalyzerFFTOrder)
+    {
+        stages[1].prepare(juce::jmin(order + 2, maxAnalyzerFFTOrder), settings.hopSize);
+        numStages = 2;
     }
 
-    // Pull every available sample from the lock-free FIFO
-    std::array<float, analyzerFFTSize * 2> tempBuffer{};
-    int numPulled = sampleFifo.pull(tempBuffer.data(),
-        static_cast<int>(tempBuffer.size()));
+    // Takes effect from the writer's next chunk
+    sampleFifo.setDecimationEnabled(settings.decimate);
 
-    if (numPulled == 0 && !hasMagnitudes)
-        return;
+    appliedSettings = settings;
+}
 
-    bool newFFTReady = false;
+void FFTPathProducer::AnalysisStage::prepare(int order, int hop)
+{
+    if (fft == nullptr || fft->getSize() != 1 << order)
+    {
+        fft = std::make_unique<juce::dsp::FFT>(order);
+        size = fft->getSize();
+
+        window.resize(static_cast<size_t>(size));
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), static_cast<size_t>(size),
+            juce::dsp::WindowingFunction<float>::hann);
+
+        history.assign(static_cast<size_t>(size), 0.0f);
+        fftData.resize(static_cast<size_t>(size * 2));
+        magnitudes.assign(static_cast<size_t>(size / 2), 0.0f);
 
-    for (int i = 0; i < numPulled; ++i)
+        historyIndex = 0;
+        hasMagnitudes = false;
+    }
+
+    hopSize = juce::jlimit(1, size, hop);
+    samplesUntilTransform = hopSize;
+}
+
+bool FFTPathProducer::AnalysisStage::push(const float* data, int numSamples, float smoothing)
+{
+    bool transformed = false;
+
+    while (numSamples > 0)
     {
-        inputBuffer[static_cast<size_t>(inputWriteIndex++)] = tempBuffer[static_cast<size_t>(i)];
+        // Copy up to the next transform or the end of the history ring
+        const auto length = juce::jmin(numSamples, samplesUntilTransform, size - historyIndex);
+
+        std::copy(data, data + length, history.data() + historyIndex);
+        data += length;
+        numSamples -= length;
 
-        if (inputWriteIndex >= analyzerFFTSize)
+        historyIndex = (historyIndex + length) % size;
+        samplesUntilTransform -= length;
+
+        if (samplesUntilTransform == 0)
         {
-            // Copy accumulated block into fftData, zero-pad the second half
-            std::copy(inputBuffer.begin(), inputBuffer.end(), fftData.begin());
-            std::fill(fftData.begin() + analyzerFFTSize, fftData.end(), 0.0f);
+            transform(smoothing);
+            samplesUntilTransform = hopSize;
+            transformed = true;
+        }
+    }
 
-            window.multiplyWithWindowingTable(fftData.data(),
-                static_cast<size_t>(analyzerFFTSize));
-            forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
+    return transformed;
+}
 
-            // Exponential smoothing on the magnitude bins
-            constexpr float smoothing = 0.9f;
-            constexpr int   numBins = analyzerFFTSize / 2;
+void FFTPathProducer::AnalysisStage::transform(float smoothing)
+{
+    // Unroll the history, oldest sample first. The upper half of fftData is
+    // scratch space for performFrequencyOnlyForwardTransform, not padding:
+    // the transform is still size points long. It is cleared so no stale
+    // bins from the last frame are left in it.
+    const auto oldest = history.begin() + historyIndex;
+    std::copy(oldest, history.end(), fftData.begin());
+    std::copy(history.begin(), oldest, fftData.begin() + (history.end() - oldest));
+    std::fill(fftData.begin() + size, fftData.end(), 0.0f);
 
-            for (int bin = 0; bin < numBins; ++bin)
-            {
-                // Correct normalisation: ×2 for one-sided spectrum,
-                // ×2 for Hann-window coherent-gain compensation = ×4/N
-                float normalized = fftData[static_cast<size_t>(bin)]
-                    * 4.0f / static_cast<float>(analyzerFFTSize);
-
-                if (hasMagnitudes)
-                    smoothedMagnitudes[static_cast<size_t>(bin)] =
-                    smoothedMagnitudes[static_cast<size_t>(bin)] * smoothing
-                    + normalized * (1.0f - smoothing);
-                else
-                    smoothedMagnitudes[static_cast<size_t>(bin)] = normalized;
-            }
+    juce::FloatVectorOperations::multiply(fftData.data(), window.data(), size);
+    fft->performFrequencyOnlyForwardTransform(fftData.data());
 
-            hasMagnitudes = true;
-            newFFTReady = true;
-            inputWriteIndex = 0;
-        }
+    // Correct normalisation: ×2 for one-sided spectrum,
+    // ×2 for Hann-window coherent-gain compensation = ×4/N
+    const auto scale = 4.0f / static_cast<float>(size);
+    const auto numBins = size / 2;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const auto normalized = fftData[static_cast<size_t>(bin)] * scale;
+        auto& magnitude = magnitudes[static_cast<size_t>(bin)];
+
+        magnitude = hasMagnitudes ? magnitude * smoothing + normalized * (1.0f - smoothing)
+                                  : normalized;
+    }
+
+    hasMagnitudes = true;
+}
+
+FFTPathProducer::BinPosition FFTPathProducer::AnalysisStage::getBinPosition(float frequency, double sampleRate) const
+{
+    // Clamped so the upper bin always exists
+    const auto lastBin = size / 2 - 2;
+    const auto fractionalBin = frequency * static_cast<float>(size) / static_cast<float>(sampleRate);
+    const auto bin = juce::jlimit(0, lastBin, static_cast<int>(fractionalBin));
+
+    return { bin, juce::jlimit(0.0f, 1.0f, fractionalBin - static_cast<float>(bin)) };
+}
+
+void FFTPathProducer::process(juce::Rectangle<float> bounds, double sampleRate)
+{
+    if (bounds.getWidth() <= 0 || bounds.getHeight() <= 0 || sampleRate <= 0)
+    {
+        drain();
+        return;
+    }
+
+    // The audio side may have decimated
+    const auto analyzedSampleRate = sampleRate / sampleFifo.getDecimation();
+
+    // Smoothing per transform, so the decay time does not depend on the hop
+    const auto smoothing = std::exp(-static_cast<float>(appliedSettings.hopSize)
+                                    / (static_cast<float>(analyzedSampleRate) * smoothingSeconds));
+
+    // The stages read straight out of the FIFO's storage
+    const auto spans = sampleFifo.prepareRead();
+    bool newFFTReady = false;
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        auto& analysisStage = stages[static_cast<size_t>(stage)];
+
+        newFFTReady |= analysisStage.push(spans.first, spans.firstSize, smoothing);
+        newFFTReady |= analysisStage.push(spans.second, spans.secondSize, smoothing);
     }
 
+    sampleFifo.finishRead(spans.size());
+
     if (newFFTReady)
-        generatePath(bounds, sampleRate);
+    {
+        generatePath(paths[static_cast<size_t>(backPath)], bounds, analyzedSampleRate);
+        publishPath();
+    }
 }
 
 void FFTPathProducer::drain()
 {
-    std::array<float, analyzerFFTSize * 2> temp{};
-    while (sampleFifo.getNumReady() > 0)
-        sampleFifo.pull(temp.data(), static_cast<int>(temp.size()));
-    inputWriteIndex = 0;
+    sampleFifo.discardAll();
 }
 
-void FFTPathProducer::generatePath(juce::Rectangle<float> bounds, double sampleRate)
+void FFTPathProducer::updatePixelMapping(float width, double sampleRate)
 {
-    const int widthInt = static_cast<int>(bounds.getWidth());
-    if (widthInt <= 0) return;
+    const auto mainSize = stages[0].size;
+    const auto lowSize = numStages > 1 ? stages[1].size : 0;
 
-    constexpr int   numBins = analyzerFFTSize / 2;
-    const float     binWidth = static_cast<float>(sampleRate)
-        / static_cast<float>(analyzerFFTSize);
+    if (width == mappedWidth && sampleRate == mappedSampleRate
+        && mainSize == mappedMainSize && lowSize == mappedLowSize)
+        return;
 
-    constexpr float minFreq = 20.0f;
-    constexpr float maxFreq = 20000.0f;
-    constexpr float negInfDB = -96.0f;   // true silence floor for gainToDecibels
-    constexpr float minDB = -48.0f;    // display bottom (wide range for analyzer)
-    constexpr float maxDB = 6.0f;      // display top
-    constexpr float visualBoostDB = 12.0f;     // brings broadband music into visible range
+    const auto numPixels = static_cast<size_t>(width);
 
-    // --- Pass 1: bin interpolation → per-pixel dB values with visual boost ---
-    std::vector<float> dbValues(static_cast<size_t>(widthInt));
+    mainPositions.resize(numPixels);
+    lowPositions.resize(lowSize > 0 ? numPixels : 0);
+    lowWeights.resize(lowSize > 0 ? numPixels : 0);
+    pixelValues.resize(numPixels);
+    smoothedValues.resize(numPixels);
+    numLowPixels = 0;
 
-    for (int x = 0; x < widthInt; ++x)
+    for (size_t x = 0; x < numPixels; ++x)
     {
-        float normX = static_cast<float>(x) / bounds.getWidth();
-        float freq = juce::mapToLog10(normX, minFreq, maxFreq);
+        const auto freq = juce::mapToLog10(static_cast<float>(x) / width, minFreq, maxFreq);
 
-        float fractBin = freq / binWidth;
-        int   bin0 = juce::jlimit(0, numBins - 1,
-            static_cast<int>(std::floor(fractBin)));
-        int   bin1 = juce::jlimit(0, numBins - 1, bin0 + 1);
-        float frac = fractBin - std::floor(fractBin);
+        mainPositions[x] = stages[0].getBinPosition(freq, sampleRate);
 
-        float magnitude = smoothedMagnitudes[static_cast<size_t>(bin0)] * (1.0f - frac)
-            + smoothedMagnitudes[static_cast<size_t>(bin1)] * frac;
+        // The long transform takes over below the crossover
+        if (lowSize > 0)
+        {
+            lowPositions[x] = stages[1].getBinPosition(freq, sampleRate);
+            lowWeights[x] = juce::jlimit(0.0f, 1.0f, 0.5f - std::log2(freq / multiResolutionCrossover));
 
-        float dB = juce::Decibels::gainToDecibels(magnitude, negInfDB) + visualBoostDB;
-        dbValues[static_cast<size_t>(x)] = juce::jlimit(minDB, maxDB, dB);
+            if (lowWeights[x] > 0.0f)
+                numLowPixels = static_cast<int>(x) + 1;
+        }
     }
 
-    // --- Pass 2 & 3: two moving-average passes (triangular kernel) ---
-    constexpr int smoothHalfWidth = 4;
+    mappedWidth = width;
+    mappedSampleRate = sampleRate;
+    mappedMainSize = mainSize;
+    mappedLowSize = lowSize;
+}
 
-    for (int pass = 0; pass < 2; ++pass)
+void FFTPathProducer::generatePath(juce::Path& path, juce::Rectangle<float> bounds, double sampleRate)
+{
+    const int widthInt = static_cast<int>(bounds.getWidth());
+    if (widthInt <= 0) return;
+
+    updatePixelMapping(bounds.getWidth(), sampleRate);
+
+    const auto& mainStage = stages[0];
+    const auto& lowStage = stages[1];
+    auto* values = pixelValues.data();
+
+    // --- Pass 1: cached bin interpolation → per-pixel magnitudes ---
+    for (int x = 0; x < widthInt; ++x)
+        values[x] = mainStage.getMagnitude(mainPositions[static_cast<size_t>(x)]);
+
+    if (numStages > 1 && lowStage.hasMagnitudes)
     {
-        std::vector<float> smoothed(static_cast<size_t>(widthInt));
-        for (int x = 0; x < widthInt; ++x)
+        for (int x = 0; x < numLowPixels; ++x)
         {
-            float sum = 0.0f;
-            int   lo = juce::jmax(0, x - smoothHalfWidth);
-            int   hi = juce::jmin(widthInt - 1, x + smoothHalfWidth);
-            for (int k = lo; k <= hi; ++k)
-                sum += dbValues[static_cast<size_t>(k)];
-            smoothed[static_cast<size_t>(x)] = sum / static_cast<float>(hi - lo + 1);
+            const auto low = lowStage.getMagnitude(lowPositions[static_cast<size_t>(x)]);
+            values[x] += (low - values[x]) * lowWeights[static_cast<size_t>(x)];
         }
-        dbValues = std::move(smoothed);
     }
 
-    // --- Pass 3: build the path ---
-    latestPath.clear();
+    // --- Pass 2: dB values with visual boost ---
+    magnitudesToDisplayDecibels(values, widthInt);
+
+    // --- Pass 3 & 4: two moving-average passes (triangular kernel) ---
+    constexpr int smoothHalfWidth = 4;
+
+    movingAverage(values, smoothedValues.data(), widthInt, smoothHalfWidth);
+    movingAverage(smoothedValues.data(), values, widthInt, smoothHalfWidth);
+
+    // --- Pass 5: build the path, reusing its storage ---
+    path.clear();
+    path.preallocateSpace(3 * widthInt);
 
     for (int x = 0; x < widthInt; ++x)
     {
-        float y = juce::jmap(dbValues[static_cast<size_t>(x)], minDB, maxDB,
+        float y = juce::jmap(values[x], minDB, maxDB,
             bounds.getBottom(), bounds.getY());
         float px = bounds.getX() + static_cast<float>(x);
 
         if (x == 0)
-            latestPath.startNewSubPath(px, y);
+            path.startNewSubPath(px, y);
         else
-            latestPath.lineTo(px, y);
+            path.lineTo(px, y);
     }
-}
\ No newline at end of file
+}
+
+//==============================================================================
+AnalyzerService::AnalyzerService()
+    : juce::Thread("SimpleEQ Analyzer")
+{
+    startThread();
+}
+
+AnalyzerService::~AnalyzerService()
+{
+    stopThread(1000);
+}
+
+void AnalyzerService::addProducer(FFTPathProducer& producer)
+{
+    const juce::ScopedLock lock(producerLock);
+    producers.addIfNotAlreadyThere(&producer);
+}
+
+void AnalyzerService::removeProducer(FFTPathProducer& producer)
+{
+    {
+        const juce::ScopedLock lock(producerLock);
+        producers.removeFirstMatchingValue(&producer);
+    }
+
+    // Off the list, it cannot be picked again; at most the update already
+    // under way has to finish
+    while (producer.isUpdating.load(std::memory_order_acquire))
+        juce::Thread::sleep(1);
+}
+
+void AnalyzerService::run()
+{
+    while (!threadShouldExit())
+    {
+        const auto start = juce::Time::getMillisecondCounter();
+
+        {
+            const juce::ScopedLock lock(producerLock);
+            roundProducers.clearQuick();
+            roundProducers.addArray(producers);
+        }
+
+        for (auto* producer : roundProducers)
+        {
+            // Removed since the copy was taken, and possibly destroyed: only
+            // the pointer is compared until it is known to be registered
+            {
+                const juce::ScopedLock lock(producerLock);
+
+                if (!producers.contains(producer))
+                    continue;
+
+                producer->isUpdating.store(true, std::memory_order_relaxed);
+            }
+
+            producer->update();
+            producer->isUpdating.store(false, std::memory_order_release);
+        }
+
+        const auto elapsed = static_cast<int>(juce::Time::getMillisecondCounter() - start);
+        wait(juce::jmax(1, updateIntervalMs - elapsed));
+    }
+}
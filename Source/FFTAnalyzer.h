@@ -1,79 +1,350 @@
 #pragma once
 #include <JuceHeader.h>
 
-constexpr int analyzerFFTOrder = 11;
-constexpr int analyzerFFTSize = 1 << analyzerFFTOrder; // 2048
+constexpr int minAnalyzerFFTOrder = 9;         // 512
+constexpr int maxAnalyzerFFTOrder = 14;        // 16384
+constexpr int defaultAnalyzerFFTOrder = 11;    // 2048
+constexpr int defaultAnalyzerHopSize = 512;
+
+//==============================================================================
+// Resolution of the spectrum analyser, changeable while it runs. A transform
+// runs every hopSize samples over the latest 2^fftOrder, so the update rate
+// no longer depends on the window length. Multi-resolution adds a transform
+// four times longer for the low end. Decimation lets the audio side thin
+// out high sample rates before they reach the FIFO.
+struct AnalyzerSettings
+{
+    int fftOrder = defaultAnalyzerFFTOrder;
+    int hopSize = defaultAnalyzerHopSize;
+    bool multiResolution = false;
+    bool decimate = true;
+
+    bool operator==(const AnalyzerSettings& other) const
+    {
+        return fftOrder == other.fftOrder && hopSize == other.hopSize && multiResolution == other.multiResolution
+            && decimate == other.decimate;
+    }
+
+    bool operator!=(const AnalyzerSettings& other) const { return !(*this == other); }
+};
 
 //==============================================================================
 // Lock-free FIFO for passing samples from the audio thread to the GUI thread.
+//
+// Nothing is stored until a reader attaches: the audio thread pushes only
+// while hasConsumer() is true, and the storage is allocated on the first
+// attach and kept from then on. The reader works on the stored samples in
+// place through prepareRead and finishRead.
+//
+// Blocks are pushed in chunks of at most maxChunkSize, so one longer than
+// the FIFO still gets through. A chunk that does not fit is dropped whole
+// and counted, so the reader never sees one torn in two.
+//
+// The writer can also decimate, so high sample rates do not flood the
+// analyser: each halving is a half-band low-pass that only computes the
+// samples it keeps.
 class SampleFifo
 {
 public:
-    SampleFifo() = default;
-
-    void push(const float* data, int numSamples)
+    // Samples ready for the reader, oldest first: first, then second
+    struct ReadSpans
     {
-        const auto scope = abstractFifo.write(numSamples);
-        if (scope.blockSize1 > 0)
-            std::copy(data, data + scope.blockSize1, buffer.data() + scope.startIndex1);
-        if (scope.blockSize2 > 0)
-            std::copy(data + scope.blockSize1,
-                data + scope.blockSize1 + scope.blockSize2,
-                buffer.data() + scope.startIndex2);
-    }
+        const float* first = nullptr;
+        int firstSize = 0;
+        const float* second = nullptr;
+        int secondSize = 0;
 
-    int pull(float* dest, int maxSamples)
+        int size() const { return firstSize + secondSize; }
+    };
+
+    SampleFifo();
+
+    // Message thread: readers attach while they draw
+    void attachConsumer();
+    void detachConsumer();
+    bool hasConsumer() const { return numConsumers.load(std::memory_order_acquire) > 0; }
+
+    // The highest power of two, up to maxDecimation, that keeps the analysed
+    // rate at or above minAnalyzedSampleRate
+    static int getDecimationFor(double sampleRate);
+
+    // Either can change at any time; the writer restarts its filters when the
+    // factor it applies changes
+    void setDecimation(int factor);
+    void setDecimationEnabled(bool shouldDecimate) { decimationEnabled.store(shouldDecimate); }
+
+    // The factor applied to the samples being pushed now
+    int getDecimation() const { return decimationEnabled.load() ? decimation.load() : 1; }
+
+    // Double-precision blocks are narrowed to float on the way in. Only call
+    // once hasConsumer() has returned true.
+    template <typename SampleType>
+    void push(const SampleType* data, int numSamples)
     {
-        const auto scope = abstractFifo.read(maxSamples);
-        int total = scope.blockSize1 + scope.blockSize2;
-        if (scope.blockSize1 > 0)
-            std::copy(buffer.data() + scope.startIndex1,
-                buffer.data() + scope.startIndex1 + scope.blockSize1,
-                dest);
-        if (scope.blockSize2 > 0)
-            std::copy(buffer.data() + scope.startIndex2,
-                buffer.data() + scope.startIndex2 + scope.blockSize2,
-                dest + scope.blockSize1);
-        return total;
+        while (numSamples > 0)
+        {
+            const auto chunkSize = juce::jmin(numSamples, maxChunkSize);
+            pushChunk(data, chunkSize);
+
+            data += chunkSize;
+            numSamples -= chunkSize;
+        }
     }
 
+    // Reader: the spans stay valid until finishRead
+    ReadSpans prepareRead() const;
+    void finishRead(int numSamples) { abstractFifo.finishedRead(numSamples); }
+    void discardAll() { finishRead(getNumReady()); }
+
     int getNumReady() const { return abstractFifo.getNumReady(); }
 
+    // Chunks dropped for lack of space since the FIFO was created
+    juce::uint32 getNumOverruns() const { return numOverruns.load(std::memory_order_relaxed); }
+
+    static constexpr double minAnalyzedSampleRate = 44100.0;
+    static constexpr int maxDecimationStages = 3;
+    static constexpr int maxDecimation = 1 << maxDecimationStages;
+
 private:
-    static constexpr int capacity = analyzerFFTSize * 4;
+    static constexpr int capacity = 4 << defaultAnalyzerFFTOrder;
+    static constexpr int maxChunkSize = capacity / 4;
+
+    // Kaiser-windowed half-band: flat to 20 kHz and 80 dB down from 28 kHz
+    // at 96 kHz in. Every other tap but the centre one is zero, and the taps
+    // are symmetric, so an output takes one multiply per pair of odd taps.
+    static constexpr int halfBandLength = 63;
+    static constexpr int halfBandCentre = halfBandLength / 2;
+    static constexpr int numHalfBandPairs = (halfBandCentre + 1) / 2;
+    static constexpr float halfBandKaiserBeta = 8.0f;
+
+    struct HalfBand
+    {
+        // Newest first from history[index]; written twice so the taps
+        // always read one contiguous run
+        std::array<float, 2 * halfBandLength> history{};
+        int index = 0;
+        bool isOddSample = false;
+    };
+
     juce::AbstractFifo abstractFifo{ capacity };
-    std::array<float, capacity> buffer{};
+    juce::HeapBlock<float> storage;
+
+    std::array<float, numHalfBandPairs> halfBandCoefficients{};
+
+    std::atomic<int> numConsumers{ 0 };
+    std::atomic<int> decimation{ 1 };
+    std::atomic<bool> decimationEnabled{ true };
+    std::atomic<juce::uint32> numOverruns{ 0 };
+
+    // Writer only
+    std::array<HalfBand, maxDecimationStages> halfBands;
+    int appliedDecimation = 1;
+    int decimationCount = 0;
+
+    void resetDecimator(int factor);
+
+    // Returns true once every stage has produced a sample, left in sample
+    bool decimateSample(float& sample, int numStages);
+
+    template <typename SampleType>
+    void pushChunk(const SampleType* data, int numSamples)
+    {
+        const auto factor = getDecimation();
+
+        if (factor != appliedDecimation)
+            resetDecimator(factor);
+
+        const auto numOut = (decimationCount + numSamples) / factor;
+
+        if (numOut > abstractFifo.getFreeSpace())
+        {
+            numOverruns.fetch_add(1, std::memory_order_relaxed);
+            resetDecimator(factor);
+            return;
+        }
+
+        int start1, size1, start2, size2;
+        abstractFifo.prepareToWrite(numOut, start1, size1, start2, size2);
+
+        if (factor == 1)
+        {
+            std::copy(data, data + size1, storage.get() + start1);
+            std::copy(data + size1, data + size1 + size2, storage.get() + start2);
+        }
+        else
+        {
+            const auto numStages = juce::findHighestSetBit(static_cast<juce::uint32>(factor));
+            int written = 0;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto sample = static_cast<float>(data[i]);
+                decimationCount = (decimationCount + 1) % factor;
+
+                if (decimateSample(sample, numStages))
+                {
+                    const auto index = written < size1 ? start1 + written : start2 + written - size1;
+                    storage[index] = sample;
+                    ++written;
+                }
+            }
+
+            jassert(written == numOut);
+        }
+
+        abstractFifo.finishedWrite(size1 + size2);
+    }
+};
+
+class FFTPathProducer;
+
+//==============================================================================
+// One analyser thread for the whole process, shared by every open editor of
+// every instance. It wakes at the display rate and updates each registered
+// producer in turn, so the message thread only draws finished paths. The
+// thread exists while at least one producer does.
+//
+// The producer lock only guards the list: a round works on a copy of it, and
+// removing a producer waits for nothing but that producer's own update.
+class AnalyzerService : private juce::Thread
+{
+public:
+    AnalyzerService();
+    ~AnalyzerService() override;
+
+    void addProducer(FFTPathProducer& producer);
+    void removeProducer(FFTPathProducer& producer);
+
+private:
+    static constexpr int updateIntervalMs = 1000 / 60;
+
+    juce::CriticalSection producerLock;
+    juce::Array<FFTPathProducer*> producers;
+    juce::Array<FFTPathProducer*> roundProducers;     // worker thread
+
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE(AnalyzerService)
 };
 
 //==============================================================================
 // Pulls samples from a SampleFifo, computes windowed FFT, and produces a
 // smoothed juce::Path suitable for drawing a spectrum analyser overlay.
+//
+// The work runs on the shared AnalyzerService thread. Finished paths are
+// handed to the message thread through a triple buffer, so neither side
+// ever waits for the other.
 class FFTPathProducer
 {
 public:
-    FFTPathProducer(SampleFifo& fifoToUse);
+    // Left off the shared thread, the producer only runs when its owner
+    // calls update(), as the benchmarks do
+    explicit FFTPathProducer(SampleFifo& fifoToUse, bool useSharedThread = true);
+    ~FFTPathProducer();
 
-    void process(juce::Rectangle<float> bounds, double sampleRate);
-    void drain();
-    juce::Path getPath() const { return latestPath; }
+    // Message thread: where and whether to draw. A disabled producer keeps
+    // its FIFO drained.
+    void setTarget(juce::Rectangle<float> bounds, double sampleRate, bool shouldBeEnabled);
+
+    // Message thread: the worker rebuilds its transforms before the next update
+    void setSettings(const AnalyzerSettings& newSettings);
+
+    // Message thread: swaps in the newest finished path, if there is one
+    bool fetchLatestPath();
+    const juce::Path& getPath() const { return paths[static_cast<size_t>(frontPath)]; }
+
+    // Worker thread: applies the latest target and settings, then analyses
+    // whatever the FIFO holds
+    void update();
 
 private:
+    friend class AnalyzerService;
+
     SampleFifo& sampleFifo;
 
-    juce::dsp::FFT forwardFFT{ analyzerFFTOrder };
-    juce::dsp::WindowingFunction<float> window{
-        static_cast<size_t>(analyzerFFTSize),
-        juce::dsp::WindowingFunction<float>::hann
+    // Lower of the two bins a pixel interpolates between
+    struct BinPosition
+    {
+        int bin = 0;
+        float fraction = 0.0f;
+    };
+
+    // One windowed transform over a sliding history, run every hop
+    struct AnalysisStage
+    {
+        void prepare(int order, int hop);
+
+        // Returns true if at least one transform ran
+        bool push(const float* data, int numSamples, float smoothing);
+
+        BinPosition getBinPosition(float frequency, double sampleRate) const;
+
+        // Linearly interpolated smoothed magnitude
+        float getMagnitude(BinPosition position) const
+        {
+            const auto* m = magnitudes.data() + position.bin;
+            return m[0] + (m[1] - m[0]) * position.fraction;
+        }
+
+        std::unique_ptr<juce::dsp::FFT> fft;
+        int size = 0, hopSize = 0;
+
+        std::vector<float> window, history, fftData, magnitudes;
+        int historyIndex = 0, samplesUntilTransform = 0;
+        bool hasMagnitudes = false;
+
+        void transform(float smoothing);
     };
 
-    std::array<float, analyzerFFTSize>     inputBuffer{};
-    int inputWriteIndex = 0;
+    static constexpr float smoothingSeconds = 0.44f;          // 0.9 per 2048 samples at 44.1 kHz
+    static constexpr float multiResolutionCrossover = 400.0f; // Hz, blended over an octave
 
-    std::array<float, analyzerFFTSize * 2> fftData{};
-    std::array<float, analyzerFFTSize / 2> smoothedMagnitudes{};
-    bool hasMagnitudes = false;
+    std::array<AnalysisStage, 2> stages;
+    int numStages = 0;
+    AnalyzerSettings appliedSettings;
 
-    juce::Path latestPath;
+    // Where each pixel reads the spectrum, rebuilt only when the width, rate
+    // or transform sizes change. Only the first numLowPixels pixels blend in
+    // the long transform.
+    std::vector<BinPosition> mainPositions, lowPositions;
+    std::vector<float> lowWeights;
+    int numLowPixels = 0;
+    float mappedWidth = 0.0f;
+    double mappedSampleRate = 0.0;
+    int mappedMainSize = 0, mappedLowSize = 0;
 
-    void generatePath(juce::Rectangle<float> bounds, double sampleRate);
-};
\ No newline at end of file
+    std::vector<float> pixelValues, smoothedValues;
+
+    // Triple buffer: the worker owns backPath, the message thread owns
+    // frontPath, and readyPath holds the newest finished one plus a flag
+    // saying the message thread has not taken it yet
+    static constexpr int freshPathFlag = 4;
+    std::array<juce::Path, 3> paths;
+    int backPath = 0, frontPath = 1;
+    std::atomic<int> readyPath{ 2 };
+
+    bool attached = false;          // message thread
+
+    juce::SpinLock targetLock;      // never taken by the audio thread
+    juce::Rectangle<float> targetBounds;
+    double targetSampleRate = 0.0;
+    bool enabled = false;
+    AnalyzerSettings targetSettings;
+
+    // Only held on the shared thread, so a standalone producer neither
+    // creates the service nor keeps its thread alive
+    std::unique_ptr<juce::SharedResourcePointer<AnalyzerService>> service;
+
+    // Set by the service, under its lock, while it updates this producer
+    std::atomic<bool> isUpdating{ false };
+
+    // Worker thread
+    void prepareStages(const AnalyzerSettings& settings);
+    void process(juce::Rectangle<float> bounds, double sampleRate);
+    void drain();
+    void updatePixelMapping(float width, double sampleRate);
+    void generatePath(juce::Path& path, juce::Rectangle<float> bounds, double sampleRate);
+    void publishPath();
+
+    JUCE_DECLARE_NON_COPYABLE(FFTPathProducer)
+};
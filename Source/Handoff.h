@@ -0,0 +1,52 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Hands objects built on other threads to the audio thread through a single
+// atomic pointer. The audio thread never allocates, frees or locks: the
+// publishing side owns every object, the audio thread flags the ones it is
+// done with, and flagged objects - along with objects replaced before the
+// audio thread took them - are freed on the next publish.
+template <typename ObjectType>
+class Handoff
+{
+public:
+    struct Entry
+    {
+        ObjectType object;
+        std::atomic<bool> released{ false };
+    };
+
+    Handoff() = default;
+
+    // Any thread but the audio one
+    void publish(std::unique_ptr<Entry> entry)
+    {
+        const juce::SpinLock::ScopedLockType lock(publishLock);
+
+        if (auto* superseded = pending.exchange(entry.get()))
+            superseded->released.store(true);
+
+        published.erase(std::remove_if(published.begin(), published.end(),
+            [](const auto& e) { return e->released.load(); }), published.end());
+
+        published.push_back(std::move(entry));
+    }
+
+    // Audio thread: the newest entry published since the last call, if any
+    Entry* take() { return pending.exchange(nullptr); }
+
+    // Audio thread: the entry will not be read again
+    static void release(Entry* entry)
+    {
+        if (entry != nullptr)
+            entry->released.store(true);
+    }
+
+private:
+    std::atomic<Entry*> pending{ nullptr };
+    std::vector<std::unique_ptr<Entry>> published;
+    juce::SpinLock publishLock;     // never taken by the audio thread
+
+    JUCE_DECLARE_NON_COPYABLE(Handoff)
+};
@@ -0,0 +1,308 @@
+#include "LinearPhaseFilter.h"
+#include "PluginProcessor.h"
+
+LinearPhaseFilter::LinearPhaseFilter(SimpleEQAudioProcessor& processorToFollow)
+    : juce::Thread("Linear Phase Designer"),
+    processor(processorToFollow)
+{
+}
+
+LinearPhaseFilter::~LinearPhaseFilter()
+{
+    release();
+}
+
+void LinearPhaseFilter::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    // The designer thread touches the convolutions, so it sits this out
+    release();
+
+    sampleRate = spec.sampleRate;
+
+    const auto numChannels = static_cast<int>(spec.numChannels);
+    convolutions.clear();
+
+    for (int firstChannel = 0; firstChannel < numChannels; firstChannel += 2)
+    {
+        auto convolution = std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::Latency{ 0 }, messageQueue);
+        convolution->prepare({ spec.sampleRate, spec.maximumBlockSize, static_cast<juce::uint32>(juce::jmin(2, numChannels - firstChannel)) });
+        convolutions.push_back(std::move(convolution));
+    }
+
+    conversionBuffer.setSize(numChannels, static_cast<int>(spec.maximumBlockSize));
+    responseCascade.prepare({ spec.sampleRate, 0, 0 }, NumCascadeSections);
+
+    // The longest kernel's latency plus a block fits in the bridge's delay
+    const auto maximumLatency = (minimumKernelLength << (numKernelLengths - 1)) / 2;
+    bridgeInput.setSize(numChannels, static_cast<int>(spec.maximumBlockSize));
+    bridgeDelay.setSize(numChannels, juce::nextPowerOfTwo(maximumLatency + static_cast<int>(spec.maximumBlockSize)));
+
+    // The new convolutions start without a kernel, so the minimum-phase
+    // path stands in for them
+    designedLength = 0;
+    bridging = true;
+    bridgeHold = -1;
+    bridgeGain = 0.0f;
+    bridgeDelay.clear();
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void LinearPhaseFilter::release()
+{
+    stopThread(2000);
+}
+
+void LinearPhaseFilter::reset()
+{
+    for (auto& convolution : convolutions)
+        convolution->reset();
+
+    bridgeDelay.clear();
+}
+
+bool LinearPhaseFilter::isKernelLoaded() const
+{
+    // The dry engine a convolution starts with holds a one-tap kernel
+    return !convolutions.empty() && convolutions.front()->getCurrentIRSize() > 1;
+}
+
+void LinearPhaseFilter::setKernelLength(int numTaps)
+{
+    jassert(juce::isPowerOfTwo(numTaps) && numTaps >= minimumKernelLength);
+    kernelLength.store(numTaps);
+}
+
+int LinearPhaseFilter::getLatencySamples() const
+{
+    // The kernel playing sets the delay, so a length change is reported once
+    // its kernel is in. Until the first one is, the bridge delays by the
+    // length being designed.
+    const int playingLength = isKernelLoaded() ? convolutions.front()->getCurrentIRSize() : getKernelLength();
+    const int convolutionLatency = convolutions.empty() ? 0 : convolutions.front()->getLatency();
+    return playingLength / 2 + convolutionLatency;
+}
+
+void LinearPhaseFilter::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    const auto& block = context.getOutputBlock();
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    const bool isEncoding = midSide && numChannels == 2;
+
+    if (isEncoding)
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto mid = (left[i] + right[i]) * 0.5f;
+            right[i] = (left[i] - right[i]) * 0.5f;
+            left[i] = mid;
+        }
+    }
+
+    for (size_t pair = 0; pair < convolutions.size() && pair * 2 < numChannels; ++pair)
+    {
+        auto pairBlock = block.getSubsetChannelBlock(pair * 2, juce::jmin<size_t>(2, numChannels - pair * 2));
+        convolutions[pair]->process(juce::dsp::ProcessContextReplacing<float>(pairBlock));
+    }
+
+    if (isEncoding)
+    {
+        auto* mid = block.getChannelPointer(0);
+        auto* side = block.getChannelPointer(1);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto left = mid[i] + side[i];
+            side[i] = mid[i] - side[i];
+            mid[i] = left;
+        }
+    }
+}
+
+void LinearPhaseFilter::process(const juce::dsp::ProcessContextReplacing<double>& context)
+{
+    const auto& block = context.getOutputBlock();
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+
+    jassert(numChannels <= static_cast<size_t>(conversionBuffer.getNumChannels()));
+    jassert(numSamples <= static_cast<size_t>(conversionBuffer.getNumSamples()));
+
+    auto floatBlock = juce::dsp::AudioBlock<float>(conversionBuffer)
+        .getSubsetChannelBlock(0, numChannels)
+        .getSubBlock(0, numSamples);
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = block.getChannelPointer(channel);
+        auto* destination = floatBlock.getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = static_cast<float>(source[i]);
+    }
+
+    process(juce::dsp::ProcessContextReplacing<float>(floatBlock));
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = floatBlock.getChannelPointer(channel);
+        auto* destination = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = static_cast<double>(source[i]);
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseFilter::beginBridge(const juce::dsp::AudioBlock<SampleType>& input)
+{
+    jassert(input.getNumChannels() <= static_cast<size_t>(bridgeInput.getNumChannels()));
+    jassert(input.getNumSamples() <= static_cast<size_t>(bridgeInput.getNumSamples()));
+
+    for (size_t channel = 0; channel < input.getNumChannels(); ++channel)
+    {
+        const auto* source = input.getChannelPointer(channel);
+        auto* destination = bridgeInput.getWritePointer(static_cast<int>(channel));
+
+        for (size_t i = 0; i < input.getNumSamples(); ++i)
+            destination[i] = static_cast<float>(source[i]);
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseFilter::finishBridge(const juce::dsp::ProcessContextReplacing<SampleType>& minimumPhaseContext)
+{
+    const auto& block = minimumPhaseContext.getOutputBlock();
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+
+    // The convolution runs all along, so its history is full by the time
+    // the bridge fades into it
+    auto convolved = juce::dsp::AudioBlock<float>(bridgeInput)
+        .getSubsetChannelBlock(0, numChannels)
+        .getSubBlock(0, block.getNumSamples());
+    process(juce::dsp::ProcessContextReplacing<float>(convolved));
+
+    if (bridgeHold < 0 && isKernelLoaded())
+        bridgeHold = juce::roundToInt(convolutionFadeSeconds * sampleRate);
+
+    const auto latency = getLatencySamples();
+    const auto mask = bridgeDelay.getNumSamples() - 1;
+    const auto step = static_cast<float>(1.0 / (bridgeFadeSeconds * sampleRate));
+
+    int hold = bridgeHold;
+    float gain = bridgeGain;
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+        const auto* wet = convolved.getChannelPointer(channel);
+        auto* delay = bridgeDelay.getWritePointer(static_cast<int>(channel));
+
+        // Every channel follows the same ramp
+        hold = bridgeHold;
+        gain = bridgeGain;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto position = bridgeWritePosition + i;
+            delay[position & mask] = static_cast<float>(samples[i]);
+            const auto delayed = delay[(position - latency) & mask];
+
+            samples[i] = static_cast<SampleType>(delayed + (wet[i] - delayed) * gain);
+
+            if (hold > 0)
+                --hold;
+            else if (hold == 0)
+                gain = juce::jmin(1.0f, gain + step);
+        }
+    }
+
+    bridgeWritePosition = (bridgeWritePosition + numSamples) & mask;
+    bridgeHold = hold;
+    bridgeGain = gain;
+    bridging = gain < 1.0f;
+}
+
+template void LinearPhaseFilter::beginBridge<float>(const juce::dsp::AudioBlock<float>&);
+template void LinearPhaseFilter::beginBridge<double>(const juce::dsp::AudioBlock<double>&);
+template void LinearPhaseFilter::finishBridge<float>(const juce::dsp::ProcessContextReplacing<float>&);
+template void LinearPhaseFilter::finishBridge<double>(const juce::dsp::ProcessContextReplacing<double>&);
+
+//==============================================================================
+void LinearPhaseFilter::run()
+{
+    while (!threadShouldExit())
+    {
+        const auto numTaps = kernelLength.load();
+        const auto version = processor.getSettingsVersion();
+
+        if (enabled.load() && (version != designedVersion || numTaps != designedLength))
+        {
+            // A snapshot still behind the version gets redesigned on the next poll
+            designedVersion = designKernel(numTaps);
+            designedLength = numTaps;
+        }
+
+        wait(pollIntervalMs);
+    }
+}
+
+juce::uint32 LinearPhaseFilter::designKernel(int numTaps)
+{
+    using Window = juce::dsp::WindowingFunction<float>;
+
+    // Before the audio thread has applied any settings, the parameters stand in
+    ChainSettings chainSettings;
+    const auto version = processor.getAppliedSettings(chainSettings);
+
+    if (version == 0)
+        chainSettings = processor.getChainSettings();
+
+    // Modulated bands still run after the convolution; every other stage
+    // goes into the kernel
+    chainSettings.filterEngine = Engine_Biquad;
+
+    updateCascade(responseCascade, chainSettings, sampleRate, allStages);
+
+    // One kernel per coefficient set in use
+    const bool isStereo = responseCascade.getChannelMode() != BiquadCascade<double>::ChannelMode::Shared;
+    const int numKernels = isStereo ? 2 : 1;
+
+    juce::dsp::FFT fft(juce::roundToInt(std::log2(numTaps)));
+    std::vector<float> spectrum(static_cast<size_t>(numTaps * 2));
+
+    // The impulse response is even around sample 0: rotate it to the middle
+    // of the kernel and taper it with a window centred on the same sample
+    std::vector<float> window(static_cast<size_t>(numTaps + 1));
+    Window::fillWindowingTables(window.data(), window.size(), Window::blackman, false);
+
+    juce::AudioBuffer<float> kernel(numKernels, numTaps);
+
+    for (int set = 0; set < numKernels; ++set)
+    {
+        // Zero-phase spectrum holding the magnitude of the minimum-phase design
+        std::fill(spectrum.begin(), spectrum.end(), 0.0f);
+
+        for (int bin = 0; bin <= numTaps / 2; ++bin)
+            spectrum[static_cast<size_t>(bin * 2)] = static_cast<float>(responseCascade.getMagnitudeForFrequency(bin * sampleRate / numTaps, sampleRate, set));
+
+        fft.performRealOnlyInverseTransform(spectrum.data());
+
+        auto* taps = kernel.getWritePointer(set);
+
+        for (int i = 0; i < numTaps; ++i)
+            taps[i] = spectrum[static_cast<size_t>((i + numTaps / 2) % numTaps)] * window[static_cast<size_t>(i)];
+    }
+
+    for (auto& convolution : convolutions)
+        convolution->loadImpulseResponse(juce::AudioBuffer<float>(kernel), sampleRate,
+            isStereo ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no,
+            juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+
+    return version;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+
+class SimpleEQAudioProcessor;
+
+//==============================================================================
+// Linear-phase version of the EQ. A background thread samples the magnitude
+// response of the settings the audio thread last applied (morphed and
+// smoothed, as the cascade would run them), turns it into a symmetric FIR kernel by
+// frequency sampling (zero-phase inverse FFT, centred and windowed), and hands
+// it to juce::dsp::Convolution, which filters with uniformly partitioned FFT
+// convolution.
+//
+// Kernel swaps never block the audio thread: Convolution builds the new engine
+// off the audio thread and crossfades to it. The kernel is centred, so the
+// filter delays the signal by half its length.
+//
+// juce::dsp::Convolution handles at most two channels, so wider layouts get
+// one convolution per channel pair, all fed the same kernel. In the dual-mono
+// and mid/side modes (stereo only) the pair gets a two-channel kernel, and in
+// mid/side the block is encoded before the convolution and decoded after.
+// Double-precision blocks are converted to float for the convolution.
+//
+// Until its first kernel is in, a freshly prepared convolution passes audio
+// dry and undelayed, while the plugin already reports the latency. Until
+// then the caller bridges: it filters each block with the minimum-phase
+// cascade between beginBridge() and finishBridge(), which delay that output
+// by the latency and crossfade into the convolution once its kernel has
+// settled.
+class LinearPhaseFilter : private juce::Thread
+{
+public:
+    static constexpr int minimumKernelLength = 4096;
+    static constexpr int numKernelLengths = 4;       // 4096 .. 32768 taps
+
+    explicit LinearPhaseFilter(SimpleEQAudioProcessor& processorToFollow);
+    ~LinearPhaseFilter() override;
+
+    // Allocates the convolutions and starts the designer thread; not real-time safe
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void release();
+    void reset();
+
+    // Called from the audio thread; the designer picks changes up on its next poll
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled); }
+    void setMidSide(bool shouldUseMidSide) { midSide = shouldUseMidSide; }
+    void setKernelLength(int numTaps);
+    int getKernelLength() const { return kernelLength.load(); }
+
+    // Half the length of the kernel playing, which lags a setKernelLength
+    // until the designer and the convolution have loaded the new one
+    int getLatencySamples() const;
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context);
+    void process(const juce::dsp::ProcessContextReplacing<double>& context);
+
+    // Audio thread. While bridging, beginBridge() keeps a copy of the input
+    // for the convolution; the caller then filters the block in place with
+    // the minimum-phase path and hands it to finishBridge().
+    bool isBridging() const { return bridging; }
+
+    template <typename SampleType>
+    void beginBridge(const juce::dsp::AudioBlock<SampleType>& input);
+
+    template <typename SampleType>
+    void finishBridge(const juce::dsp::ProcessContextReplacing<SampleType>& minimumPhaseContext);
+
+private:
+    static constexpr int pollIntervalMs = 20;
+
+    // juce::dsp::Convolution crossfades from its dry engine into a new one
+    // over 50 ms; the bridge waits that out, then fades over its own time
+    static constexpr double convolutionFadeSeconds = 0.05;
+    static constexpr double bridgeFadeSeconds = 0.02;
+
+    SimpleEQAudioProcessor& processor;
+
+    juce::dsp::ConvolutionMessageQueue messageQueue;
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;   // one per channel pair
+    juce::AudioBuffer<float> conversionBuffer;
+
+    double sampleRate = 0.0;
+    bool midSide = false;       // audio thread only
+    std::atomic<bool> enabled{ false };
+    std::atomic<int> kernelLength{ minimumKernelLength };
+
+    // Bridge, audio thread only. bridgeHold counts down the convolution's
+    // own fade once its kernel is in, and is -1 until then.
+    juce::AudioBuffer<float> bridgeInput;
+    juce::AudioBuffer<float> bridgeDelay;       // power-of-two rings, one per channel
+    int bridgeWritePosition = 0;
+    int bridgeHold = -1;
+    float bridgeGain = 0.0f;
+    bool bridging = false;
+
+    bool isKernelLoaded() const;
+
+    // Designer thread state
+    BiquadCascade<double> responseCascade;
+    juce::uint32 designedVersion = 0;
+    int designedLength = 0;
+
+    void run() override;
+    // Returns the version of the settings it designed for
+    juce::uint32 designKernel(int numTaps);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseFilter)
+};
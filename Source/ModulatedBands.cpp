@@ -0,0 +1,305 @@
+#include "ModulatedBands.h"
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, int numBandsToUse, int numCutSectionsToUse)
+{
+    jassert(numBandsToUse >= 0);
+    jassert(numCutSectionsToUse >= 0);
+
+    numBands = numBandsToUse;
+    numCutSections = numCutSectionsToUse;
+    numStages = numBands + 2 * numCutSections;
+    numChannels = static_cast<int>(spec.numChannels);
+    sampleRate = spec.sampleRate;
+
+    attackCoefficient = static_cast<SampleType>(std::exp(-1.0 / (attackSeconds * sampleRate)));
+    releaseCoefficient = static_cast<SampleType>(std::exp(-1.0 / (releaseSeconds * sampleRate)));
+
+    stages.assign(static_cast<size_t>(numStages), Stage());
+    state.resize(static_cast<size_t>(numChannels * numStages * StateVariableFilter::stateSize));
+    levels.resize(static_cast<size_t>(spec.maximumBlockSize));
+    numActive = 0;
+
+    reset();
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::reset()
+{
+    std::fill(state.begin(), state.end(), SampleType(0));
+    envelope = 0;
+    numLevels = 0;
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::clearState(int index)
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* stageState = state.data() + (channel * numStages + index) * StateVariableFilter::stateSize;
+        std::fill(stageState, stageState + StateVariableFilter::stateSize, SampleType(0));
+    }
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::setStage(int index, bool shouldBeActive, StateVariableFilter::Type type,
+                                          float frequency, float gainDb, float Q, const BandModulation& modulation, int channel)
+{
+    auto& stage = stages[static_cast<size_t>(index)];
+
+    stage.targetFrequency = static_cast<SampleType>(frequency);
+    stage.targetGainDb = static_cast<SampleType>(gainDb);
+    stage.targetQ = static_cast<SampleType>(Q);
+
+    if (stage.active != shouldBeActive)
+    {
+        // A stage switched in starts at its settings instead of gliding there
+        if (shouldBeActive)
+        {
+            clearState(index);
+            stage.frequency = stage.targetFrequency;
+            stage.gainDb = stage.targetGainDb;
+            stage.Q = stage.targetQ;
+            stage.needsCoefficients = true;
+        }
+
+        stage.active = shouldBeActive;
+        numActive += shouldBeActive ? 1 : -1;
+    }
+
+    if (stage.type != type)
+    {
+        stage.type = type;
+        stage.needsCoefficients = true;
+    }
+
+    stage.channel = channel;
+
+    stage.lfoIncrement = static_cast<SampleType>(juce::MathConstants<double>::twoPi * modulation.lfoRate / sampleRate);
+    stage.lfoDepth = static_cast<SampleType>(modulation.lfoDepth);
+    stage.envelopeDepth = static_cast<SampleType>(modulation.envelopeDepth);
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::setBand(int band, bool shouldBeActive, StateVariableFilter::Type type,
+                                         float frequency, float gainDb, float Q, const BandModulation& modulation, int channel)
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+
+    setStage(numCutSections + band, shouldBeActive, type, frequency, gainDb, Q, modulation, channel);
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::setCutSection(Cut cut, int section, bool shouldBeActive, float frequency, float Q)
+{
+    jassert(juce::isPositiveAndBelow(section, numCutSections));
+
+    if (cut == Cut::Low)
+        setStage(section, shouldBeActive, StateVariableFilter::Type::HighPass, frequency, 0.0f, Q, {}, -1);
+    else
+        setStage(numCutSections + numBands + section, shouldBeActive, StateVariableFilter::Type::LowPass, frequency, 0.0f, Q, {}, -1);
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::setMidSide(bool shouldUseMidSide)
+{
+    if (midSide == shouldUseMidSide)
+        return;
+
+    midSide = shouldUseMidSide;
+
+    if (numChannels != 2)
+        return;
+
+    // As BiquadCascade: the state goes through the mid/side matrix with the
+    // audio instead of restarting from silence
+    const auto scale = midSide ? SampleType(0.5) : SampleType(1);
+    auto* first = state.data();
+    auto* second = state.data() + numStages * StateVariableFilter::stateSize;
+
+    for (int i = 0; i < numStages * StateVariableFilter::stateSize; ++i)
+    {
+        const auto sum = (first[i] + second[i]) * scale;
+        const auto difference = (first[i] - second[i]) * scale;
+        first[i] = sum;
+        second[i] = difference;
+    }
+}
+
+template <typename SampleType>
+bool ModulatedBands<SampleType>::isActive(int band) const
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+    return stages[static_cast<size_t>(numCutSections + band)].active;
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::followEnvelope(const juce::dsp::AudioBlock<SampleType>& input)
+{
+    jassert(input.getNumSamples() <= levels.size());
+
+    numLevels = juce::jmin(input.getNumSamples(), levels.size());
+
+    for (size_t i = 0; i < numLevels; ++i)
+    {
+        SampleType level = 0;
+
+        for (size_t channel = 0; channel < input.getNumChannels(); ++channel)
+            level = juce::jmax(level, std::abs(input.getSample(static_cast<int>(channel), static_cast<int>(i))));
+
+        const auto coefficient = level > envelope ? attackCoefficient : releaseCoefficient;
+        envelope = level + coefficient * (envelope - level);
+
+        levels[i] = juce::jmin(envelope, SampleType(1));
+    }
+}
+
+template <typename SampleType>
+void ModulatedBands<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
+{
+    using FastMath = juce::dsp::FastMathApproximations;
+
+    auto& block = context.getOutputBlock();
+
+    if (context.isBypassed || numActive == 0 || block.getNumSamples() == 0)
+        return;
+
+    const auto numSamples = block.getNumSamples();
+    const auto numBlockChannels = juce::jmin(static_cast<int>(block.getNumChannels()), numChannels);
+
+    const auto pi = juce::MathConstants<SampleType>::pi;
+    const auto ln2 = SampleType(0.6931471805599453);
+    const auto inverseSampleRate = static_cast<SampleType>(1.0 / sampleRate);
+    const auto inverseNumSamples = SampleType(1) / static_cast<SampleType>(numSamples);
+
+    const auto isEncoding = midSide && numBlockChannels == 2;
+
+    // The block must line up with the one the envelope followed
+    jassert(numSamples <= numLevels);
+
+    // Glides reach their targets on the last sample of the block
+    for (auto& stage : stages)
+    {
+        stage.isGliding = stage.active
+            && (stage.frequency != stage.targetFrequency || stage.gainDb != stage.targetGainDb || stage.Q != stage.targetQ);
+
+        if (stage.isGliding)
+        {
+            stage.frequencyStep = std::pow(stage.targetFrequency / stage.frequency, inverseNumSamples);
+            stage.gainStep = (stage.targetGainDb - stage.gainDb) * inverseNumSamples;
+            stage.QStep = std::pow(stage.targetQ / stage.Q, inverseNumSamples);
+        }
+        else if (stage.active && stage.needsCoefficients && !stage.isModulated())
+        {
+            stage.coefficients = StateVariableFilter::makeCoefficients(stage.type,
+                stage.frequency * inverseSampleRate, stage.Q, stage.gainDb);
+            stage.needsCoefficients = false;
+        }
+    }
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto level = numLevels > 0 ? levels[juce::jmin(i, numLevels - 1)] : SampleType(0);
+
+        if (isEncoding)
+        {
+            auto& left = block.getChannelPointer(0)[i];
+            auto& right = block.getChannelPointer(1)[i];
+            const auto mid = (left + right) * SampleType(0.5);
+            const auto side = (left - right) * SampleType(0.5);
+
+            left = mid;
+            right = side;
+        }
+
+        for (int index = 0; index < numStages; ++index)
+        {
+            auto& stage = stages[static_cast<size_t>(index)];
+
+            if (!stage.active)
+                continue;
+
+            if (stage.isGliding)
+            {
+                stage.frequency *= stage.frequencyStep;
+                stage.gainDb += stage.gainStep;
+                stage.Q *= stage.QStep;
+            }
+
+            if (stage.isModulated())
+            {
+                const auto octaves = juce::jlimit(-maxOctaves, maxOctaves, stage.lfoDepth * FastMath::sin(stage.lfoPhase) + stage.envelopeDepth * level);
+                const auto frequency = stage.frequency * FastMath::exp(octaves * ln2);
+
+                stage.coefficients = StateVariableFilter::makeCoefficients(stage.type,
+                    frequency * inverseSampleRate, stage.Q, stage.gainDb);
+
+                // Kept in [-pi, pi), the range of FastMathApproximations::sin
+                stage.lfoPhase += stage.lfoIncrement;
+                if (stage.lfoPhase >= pi)
+                    stage.lfoPhase -= 2 * pi;
+            }
+            else if (stage.isGliding)
+            {
+                stage.coefficients = StateVariableFilter::makeCoefficients(stage.type,
+                    stage.frequency * inverseSampleRate, stage.Q, stage.gainDb);
+            }
+
+            for (int channel = 0; channel < numBlockChannels; ++channel)
+            {
+                if (stage.channel >= 0 && stage.channel != channel)
+                    continue;
+
+                auto* samples = block.getChannelPointer(static_cast<size_t>(channel));
+                auto* stageState = state.data() + (channel * numStages + index) * StateVariableFilter::stateSize;
+
+                samples[i] = StateVariableFilter::processSample(stage.coefficients, stageState, samples[i]);
+            }
+        }
+
+        if (isEncoding)
+        {
+            auto& mid = block.getChannelPointer(0)[i];
+            auto& side = block.getChannelPointer(1)[i];
+            const auto left = mid + side;
+            const auto right = mid - side;
+
+            mid = left;
+            side = right;
+        }
+    }
+
+    // The steps leave rounding errors; static stages settle exactly on their
+    // targets and get their coefficients back on the next block
+    for (auto& stage : stages)
+    {
+        if (!stage.isGliding)
+            continue;
+
+        stage.frequency = stage.targetFrequency;
+        stage.gainDb = stage.targetGainDb;
+        stage.Q = stage.targetQ;
+        stage.isGliding = false;
+        stage.needsCoefficients = true;
+    }
+
+    for (auto& sample : state)
+        juce::dsp::util::snapToZero(sample);
+}
+
+template <typename SampleType>
+SampleType ModulatedBands<SampleType>::getStateMagnitude() const
+{
+    SampleType magnitude = 0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int index = 0; index < numStages; ++index)
+            if (stages[static_cast<size_t>(index)].active)
+                for (int i = 0; i < StateVariableFilter::stateSize; ++i)
+                    magnitude = juce::jmax(magnitude, std::abs(state[static_cast<size_t>((channel * numStages + index) * StateVariableFilter::stateSize + i)]));
+
+    return magnitude;
+}
+
+template class ModulatedBands<float>;
+template class ModulatedBands<double>;
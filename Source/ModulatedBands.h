@@ -0,0 +1,122 @@
+#pragma once
+#include <JuceHeader.h>
+#include "StateVariableFilter.h"
+
+//==============================================================================
+// Modulation of one band: an LFO and an envelope follower, both moving
+// the centre frequency in octaves around its parameter value
+struct BandModulation
+{
+    float lfoRate = 1.0f;           // Hz
+    float lfoDepth = 0.0f;          // octaves, either side of the centre
+    float envelopeDepth = 0.0f;     // octaves at full scale, may be negative
+
+    bool isActive() const { return lfoDepth != 0.0f || envelopeDepth != 0.0f; }
+};
+
+//==============================================================================
+// Stages run as state-variable filters, with coefficients that can move
+// every sample: bands with modulation, and with the state-variable engine
+// selected, every band and the sections of both cut filters. Stages handed
+// to this engine are switched out of the BiquadCascade.
+//
+// Settings arrive once per control block. Frequency, gain and Q glide to
+// them sample by sample across the next process() call, so the coefficients
+// never jump; stages that neither glide nor are modulated keep their
+// coefficients from one sample to the next.
+//
+// The envelope follows the peak level of the unfiltered input across all
+// channels, so every channel sees the same filter. A band can be limited to
+// one channel; in mid/side mode the first two channels are encoded and
+// decoded around the stages sample by sample, within the same pass.
+template <typename SampleType>
+class ModulatedBands
+{
+public:
+    enum class Cut
+    {
+        Low,        // high-pass sections
+        High        // low-pass sections
+    };
+
+    ModulatedBands() = default;
+
+    // Allocates the per-channel state and the envelope buffer; not real-time
+    // safe. Each cut filter gets numCutSectionsToUse second-order sections.
+    void prepare(const juce::dsp::ProcessSpec& spec, int numBandsToUse, int numCutSectionsToUse);
+    void reset();
+
+    // Sets the shape and modulation of a band. Bands that are not active
+    // pass audio untouched and have their state cleared. A channel of -1
+    // filters every channel.
+    void setBand(int band, bool shouldBeActive, StateVariableFilter::Type type,
+                 float frequency, float gainDb, float Q, const BandModulation& modulation, int channel = -1);
+
+    // Sets one section of a cut filter, which filters every channel
+    void setCutSection(Cut cut, int section, bool shouldBeActive, float frequency, float Q);
+
+    // Stereo only; switching carries the state across the mid/side matrix
+    void setMidSide(bool shouldUseMidSide);
+    bool isActive(int band) const;
+    bool isProcessing() const { return numActive > 0; }
+
+    // Follows the level of the input before any filtering. The block given
+    // to the next process() call must be no longer than this one, and start
+    // at the same sample.
+    void followEnvelope(const juce::dsp::AudioBlock<SampleType>& input);
+
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context);
+
+    // Largest absolute state value of the active stages
+    SampleType getStateMagnitude() const;
+
+private:
+    static constexpr double attackSeconds = 0.005;
+    static constexpr double releaseSeconds = 0.15;
+    static constexpr SampleType maxOctaves = 4;
+
+    struct Stage
+    {
+        bool active = false;
+        StateVariableFilter::Type type = StateVariableFilter::Type::Bell;
+        int channel = -1;
+
+        // Values reached at the current sample, and the ones they glide to
+        SampleType frequency = 1000, gainDb = 0, Q = 1;
+        SampleType targetFrequency = 1000, targetGainDb = 0, targetQ = 1;
+        SampleType frequencyStep = 1, gainStep = 0, QStep = 1;
+        bool isGliding = false;
+
+        SampleType lfoPhase = 0, lfoIncrement = 0, lfoDepth = 0;
+        SampleType envelopeDepth = 0;
+
+        // Of the current values, while neither gliding nor modulated
+        StateVariableFilter::Coefficients<SampleType> coefficients;
+        bool needsCoefficients = true;
+
+        bool isModulated() const { return lfoDepth != 0 || envelopeDepth != 0; }
+    };
+
+    int numBands = 0;
+    int numCutSections = 0;
+    int numStages = 0;
+    int numChannels = 0;
+    int numActive = 0;
+    bool midSide = false;
+    double sampleRate = 44100.0;
+
+    SampleType envelope = 0;
+    SampleType attackCoefficient = 0, releaseCoefficient = 0;
+
+    // Stages in processing order: low cut sections, bands, high cut sections
+    std::vector<Stage> stages;
+    std::vector<SampleType> state;          // [channel][stage][StateVariableFilter::stateSize]
+    std::vector<SampleType> levels;         // envelope per sample of the followed block
+    size_t numLevels = 0;
+
+    void setStage(int index, bool shouldBeActive, StateVariableFilter::Type type, float frequency, float gainDb, float Q,
+                  const BandModulation& modulation, int channel);
+    void clearState(int index);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulatedBands)
+};
@@ -10,9 +10,23 @@
 #include "PluginEditor.h"
 
 static constexpr float ResponseCurveRatio = 0.50f;
-static constexpr float CutFilterRatio = 0.18f;
-
-static const juce::StringArray SlopeLabels{ "12 dB/Oct", "24 dB/Oct", "36 dB/Oct", "48 dB/Oct" };
+static constexpr int CutSectionWidth = 160;
+static constexpr int BandSectionWidth = 112;
+static constexpr int MinEditorWidth = 1040;     // room for the title bar options
+static constexpr int MaxEditorWidth = 1400;
+static constexpr int SnapshotRadioGroup = 1;
+
+static const juce::StringArray SlopeLabels{ "12 dB/Oct", "24 dB/Oct", "36 dB/Oct", "48 dB/Oct",
+                                            "60 dB/Oct", "72 dB/Oct", "84 dB/Oct", "96 dB/Oct" };
+static const juce::StringArray AlignmentLabels{ "Butterworth", "Linkwitz-Riley" };
+static const juce::StringArray BandTypeLabels{ "Bell", "Low Shelf", "High Shelf", "Notch", "Tilt", "Band Pass" };
+static const juce::StringArray PlacementLabels{ "L+R", "L/M", "R/S" };
+
+static void addParameterChoices(juce::ComboBox& combo, juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterId)
+{
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(parameterId)))
+        combo.addItemList(choice->choices, 1);
+}
 
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcessor& p)
@@ -20,29 +34,101 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     audioProcessor(p),
     responseCurveComponent(audioProcessor),
     lowCutSection(audioProcessor.treeState,
-        "LowCut Frequency", "LowCut Slope", "LowCut Bypass",
-        SlopeLabels, "LOW CUT", Theme::LowCutAccent),
-    band1Section(audioProcessor.treeState,
-        "Band1 Frequency", "Band1 Gain", "Band1 Quality", "Band1 Bypass",
-        "BAND 1", Theme::Band1Accent),
-    band2Section(audioProcessor.treeState,
-        "Band2 Frequency", "Band2 Gain", "Band2 Quality", "Band2 Bypass",
-        "BAND 2", Theme::Band2Accent),
-    band3Section(audioProcessor.treeState,
-        "Band3 Frequency", "Band3 Gain", "Band3 Quality", "Band3 Bypass",
-        "BAND 3", Theme::Band3Accent),
+        "LowCut Frequency", "LowCut Slope", "LowCut Type", "LowCut Bypass",
+        SlopeLabels, AlignmentLabels, "LOW CUT", Theme::LowCutAccent),
     highCutSection(audioProcessor.treeState,
-        "HighCut Frequency", "HighCut Slope", "HighCut Bypass",
-        SlopeLabels, "HIGH CUT", Theme::HighCutAccent)
+        "HighCut Frequency", "HighCut Slope", "HighCut Type", "HighCut Bypass",
+        SlopeLabels, AlignmentLabels, "HIGH CUT", Theme::HighCutAccent),
+    phaseModeCombo("Phase Mode", "", "", Theme::GenericAccent),
+    kernelLengthCombo("Linear Phase Length", "Taps", "", Theme::GenericAccent),
+    oversamplingCombo("Oversampling", "", "", Theme::GenericAccent),
+    filterDesignCombo("Filter Design", "", "", Theme::GenericAccent),
+    filterEngineCombo("Filter Engine", "", "", Theme::GenericAccent),
+    controlRateCombo("Control Rate", "Samples", "", Theme::GenericAccent),
+    stereoModeCombo("Stereo Mode", "", "", Theme::GenericAccent)
 {
+    addParameterChoices(phaseModeCombo, audioProcessor.treeState, "Phase Mode");
+    addParameterChoices(kernelLengthCombo, audioProcessor.treeState, "Linear Phase Length");
+    addParameterChoices(oversamplingCombo, audioProcessor.treeState, "Oversampling");
+    addParameterChoices(filterDesignCombo, audioProcessor.treeState, "Filter Design");
+    addParameterChoices(filterEngineCombo, audioProcessor.treeState, "Filter Engine");
+    addParameterChoices(controlRateCombo, audioProcessor.treeState, "Control Rate");
+    addParameterChoices(stereoModeCombo, audioProcessor.treeState, "Stereo Mode");
+    phaseModeAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.treeState, "Phase Mode", phaseModeCombo);
+    kernelLengthAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.treeState, "Linear Phase Length", kernelLengthCombo);
+    oversamplingAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.treeState, "Oversampling", oversamplingCombo);
+    filterDesignAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.treeState, "Filter Design", filterDesignCombo);
+    filterEngineAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.treeState, "Filter Engine", filterEngineCombo);
+    controlRateAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.treeState, "Control Rate", controlRateCombo);
+    stereoModeAttachment = std::make_unique<ComboBoxAttachment>(audioProcessor.treeState, "Stereo Mode", stereoModeCombo);
+
+    for (int i = 0; i < audioProcessor.numBands; ++i) {
+        const juce::String bandId = "Band" + juce::String(i + 1);
+
+        auto section = std::make_unique<BandFilterSection>(audioProcessor.treeState,
+            bandId + " Frequency", bandId + " Gain", bandId + " Quality", bandId + " Bypass",
+            bandId + " Type", BandTypeLabels,
+            bandId + " Channel", PlacementLabels,
+            bandId + " LFO Rate", bandId + " LFO Depth", bandId + " Env Depth",
+            bandId + " Dynamic", bandId + " Threshold", bandId + " Ratio", bandId + " Attack", bandId + " Release",
+            "BAND " + juce::String(i + 1), Theme::getBandAccent(i));
+
+        bandStrip.addAndMakeVisible(*section);
+        bandSections.push_back(std::move(section));
+    }
+
+    bandViewport.setViewedComponent(&bandStrip, false);
+    bandViewport.setScrollBarsShown(false, true);
+
     addAndMakeVisible(responseCurveComponent);
     addAndMakeVisible(lowCutSection);
-    addAndMakeVisible(band1Section);
-    addAndMakeVisible(band2Section);
-    addAndMakeVisible(band3Section);
+    addAndMakeVisible(bandViewport);
     addAndMakeVisible(highCutSection);
-
-    setSize(900, 750);
+    addAndMakeVisible(phaseModeCombo);
+    addAndMakeVisible(kernelLengthCombo);
+    addAndMakeVisible(oversamplingCombo);
+    addAndMakeVisible(filterDesignCombo);
+    addAndMakeVisible(filterEngineCombo);
+    addAndMakeVisible(controlRateCombo);
+    addAndMakeVisible(stereoModeCombo);
+
+    // Dynamic bands detect on the sidechain bus instead of the input
+    sidechainButton.setClickingTogglesState(true);
+    sidechainButton.setColour(juce::TextButton::buttonOnColourId, Theme::GenericAccent);
+    addAndMakeVisible(sidechainButton);
+
+    for (int i = 0; i < SimpleEQAudioProcessor::numSnapshots; ++i) {
+        auto& button = snapshotButtons[static_cast<size_t>(i)];
+
+        button.setButtonText(juce::String::charToString(static_cast<juce::juce_wchar>('A' + i)));
+        button.setRadioGroupId(SnapshotRadioGroup);
+        button.setClickingTogglesState(true);
+        button.setColour(juce::TextButton::buttonOnColourId, Theme::GenericAccent);
+        button.setConnectedEdges((i > 0 ? juce::Button::ConnectedOnLeft : 0)
+            | (i < SimpleEQAudioProcessor::numSnapshots - 1 ? juce::Button::ConnectedOnRight : 0));
+        button.setToggleState(i == audioProcessor.getSelectedSnapshot(), juce::dontSendNotification);
+        button.onClick = [this, i] { audioProcessor.selectSnapshot(i); };
+        addAndMakeVisible(button);
+    }
+
+    // The selected slot is stored as morphing starts, so it includes the
+    // latest edits
+    morphButton.setClickingTogglesState(true);
+    morphButton.setColour(juce::TextButton::buttonOnColourId, Theme::GenericAccent);
+    morphButton.onClick = [this]
+        {
+            if (morphButton.getToggleState())
+                audioProcessor.storeSnapshot();
+        };
+    addAndMakeVisible(morphButton);
+
+    morphSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    morphSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    morphSlider.setColour(juce::Slider::thumbColourId, Theme::GenericAccent);
+    addAndMakeVisible(morphSlider);
+
+    const int bandsWidth = audioProcessor.numBands * BandSectionWidth;
+    setSize(juce::jlimit(MinEditorWidth, MaxEditorWidth, 2 * CutSectionWidth + bandsWidth + 30), 750);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
@@ -85,8 +171,32 @@ void SimpleEQAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds();
 
-    // Title bar
-    bounds.removeFromTop(40);
+    // Title bar, with the options left of the version label
+    auto titleArea = bounds.removeFromTop(40).reduced(20, 8);
+    titleArea.removeFromRight(40);
+    kernelLengthCombo.setBounds(titleArea.removeFromRight(90));
+    titleArea.removeFromRight(8);
+    phaseModeCombo.setBounds(titleArea.removeFromRight(110));
+    titleArea.removeFromRight(8);
+    oversamplingCombo.setBounds(titleArea.removeFromRight(60));
+    titleArea.removeFromRight(8);
+    filterDesignCombo.setBounds(titleArea.removeFromRight(80));
+    titleArea.removeFromRight(8);
+    filterEngineCombo.setBounds(titleArea.removeFromRight(100));
+    titleArea.removeFromRight(8);
+    controlRateCombo.setBounds(titleArea.removeFromRight(50));
+    titleArea.removeFromRight(8);
+    stereoModeCombo.setBounds(titleArea.removeFromRight(80));
+    titleArea.removeFromRight(8);
+    sidechainButton.setBounds(titleArea.removeFromRight(32));
+    titleArea.removeFromRight(8);
+
+    for (int i = SimpleEQAudioProcessor::numSnapshots - 1; i >= 0; --i)
+        snapshotButtons[static_cast<size_t>(i)].setBounds(titleArea.removeFromRight(22));
+
+    titleArea.removeFromRight(8);
+    morphSlider.setBounds(titleArea.removeFromRight(80));
+    morphButton.setBounds(titleArea.removeFromRight(48));
 
     // Response curve
     auto responseArea = bounds.removeFromTop(
@@ -97,12 +207,18 @@ void SimpleEQAudioProcessorEditor::resized()
     bounds.removeFromTop(15);
     bounds = bounds.reduced(15, 10);
 
-    const int cutWidth = static_cast<int>(bounds.getWidth() * CutFilterRatio);
-    const int bandWidth = (bounds.getWidth() - 2 * cutWidth) / 3;
+    lowCutSection.setBounds(bounds.removeFromLeft(CutSectionWidth));
+    highCutSection.setBounds(bounds.removeFromRight(CutSectionWidth));
+    bandViewport.setBounds(bounds);
+
+    // Bands share the width when they fit, otherwise keep their own and scroll
+    const int numSections = static_cast<int>(bandSections.size());
+    const bool needsScrolling = numSections * BandSectionWidth > bounds.getWidth();
+    const int stripHeight = bounds.getHeight() - (needsScrolling ? bandViewport.getScrollBarThickness() : 0);
+    const int bandWidth = needsScrolling ? BandSectionWidth : bounds.getWidth() / juce::jmax(1, numSections);
+
+    bandStrip.setSize(juce::jmax(bounds.getWidth(), numSections * bandWidth), stripHeight);
 
-    lowCutSection.setBounds(bounds.removeFromLeft(cutWidth));
-    band1Section.setBounds(bounds.removeFromLeft(bandWidth));
-    band2Section.setBounds(bounds.removeFromLeft(bandWidth));
-    band3Section.setBounds(bounds.removeFromLeft(bandWidth));
-    highCutSection.setBounds(bounds);
+    for (int i = 0; i < numSections; ++i)
+        bandSections[static_cast<size_t>(i)]->setBounds(i * bandWidth, 0, bandWidth, stripHeight);
 }
\ No newline at end of file
@@ -30,11 +30,43 @@ private:
     ResponseCurveComponent responseCurveComponent;
 
     CutFilterSection  lowCutSection;
-    BandFilterSection band1Section;
-    BandFilterSection band2Section;
-    BandFilterSection band3Section;
     CutFilterSection  highCutSection;
 
+    // One section per band the processor exposes, in a strip that scrolls
+    // sideways once the bands no longer fit
+    std::vector<std::unique_ptr<BandFilterSection>> bandSections;
+    juce::Component bandStrip;
+    juce::Viewport bandViewport;
+
+    // Global options in the title bar
+    MinimalCombo phaseModeCombo;
+    MinimalCombo kernelLengthCombo;
+    MinimalCombo oversamplingCombo;
+    MinimalCombo filterDesignCombo;
+    MinimalCombo filterEngineCombo;
+    MinimalCombo controlRateCombo;
+    MinimalCombo stereoModeCombo;
+    juce::TextButton sidechainButton{ "SC" };
+
+    // A/B/C/D snapshot slots, one selected at a time
+    std::array<juce::TextButton, SimpleEQAudioProcessor::numSnapshots> snapshotButtons;
+
+    // Morph across the stored slots
+    juce::TextButton morphButton{ "MORPH" };
+    juce::Slider morphSlider;
+
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+    std::unique_ptr<ComboBoxAttachment> phaseModeAttachment;
+    std::unique_ptr<ComboBoxAttachment> kernelLengthAttachment;
+    std::unique_ptr<ComboBoxAttachment> oversamplingAttachment;
+    std::unique_ptr<ComboBoxAttachment> filterDesignAttachment;
+    std::unique_ptr<ComboBoxAttachment> filterEngineAttachment;
+    std::unique_ptr<ComboBoxAttachment> controlRateAttachment;
+    std::unique_ptr<ComboBoxAttachment> stereoModeAttachment;
+    juce::AudioProcessorValueTreeState::ButtonAttachment sidechainAttachment{ audioProcessor.treeState, "Sidechain", sidechainButton };
+    juce::AudioProcessorValueTreeState::ButtonAttachment morphEnabledAttachment{ audioProcessor.treeState, "Morph Enabled", morphButton };
+    juce::AudioProcessorValueTreeState::SliderAttachment morphPositionAttachment{ audioProcessor.treeState, "Morph", morphSlider };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimpleEQAudioProcessorEditor)
 };
 
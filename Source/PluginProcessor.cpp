@@ -9,51 +9,596 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-Coefficients makeBandFilter(const ChainSettings& chainSettings, double sampleRate, int index) 
+template <typename SampleType>
+void designBandFilter(SampleType* coefficients, const ChainSettings& chainSettings, double sampleRate, int band)
 {
-    struct PeakFilterParams
+    const auto& settings = chainSettings.bands[static_cast<size_t>(band)];
+    const auto gainFactor = juce::Decibels::decibelsToGain(static_cast<double>(settings.gain));
+
+    switch (settings.type)
     {
-        double rate = 0.0;
-        float frequency = 0.0;
-		float Q = 0.707;
-		float dBGain = 0.0;
-    };
-	PeakFilterParams params;
+        case Band_Bell:
+            if (chainSettings.filterDesign == Design_Matched)
+                CoefficientDesigner::makeMatchedPeak(coefficients, sampleRate, settings.freq, settings.Q, gainFactor);
+            else
+                CoefficientDesigner::makePeak(coefficients, sampleRate, settings.freq, settings.Q, gainFactor);
+            break;
+
+        case Band_LowShelf:
+            CoefficientDesigner::makeLowShelf(coefficients, sampleRate, settings.freq, settings.Q, gainFactor);
+            break;
+
+        case Band_HighShelf:
+            CoefficientDesigner::makeHighShelf(coefficients, sampleRate, settings.freq, settings.Q, gainFactor);
+            break;
+
+        case Band_Notch:
+            CoefficientDesigner::makeNotch(coefficients, sampleRate, settings.freq, settings.Q);
+            break;
+
+        case Band_Tilt:
+            CoefficientDesigner::makeTilt(coefficients, sampleRate, settings.freq, gainFactor);
+            break;
+
+        case Band_BandPass:
+            CoefficientDesigner::makeBandPass(coefficients, sampleRate, settings.freq, settings.Q, gainFactor);
+            break;
+    }
+}
+
+// Each 12 dB/oct step adds one second-order section, for either alignment
+static double getCutSectionQ(Slope slope, CutAlignment alignment, int section)
+{
+    const int order = 2 * (slope + 1);
+
+    if (alignment == Alignment_LinkwitzRiley)
+        return CoefficientDesigner::getLinkwitzRileyQ(order, section);
+
+    return CoefficientDesigner::getButterworthQ(order, section);
+}
+
+template <typename SampleType>
+void designLowCutSection(SampleType* coefficients, const ChainSettings& chainSettings, double sampleRate, int section)
+{
+    auto Q = getCutSectionQ(chainSettings.lowCutSlope, chainSettings.lowCutAlignment, section);
+    CoefficientDesigner::makeHighPass(coefficients, sampleRate, chainSettings.lowCutFreq, Q);
+}
+
+template <typename SampleType>
+void designHighCutSection(SampleType* coefficients, const ChainSettings& chainSettings, double sampleRate, int section)
+{
+    auto Q = getCutSectionQ(chainSettings.highCutSlope, chainSettings.highCutAlignment, section);
+
+    if (chainSettings.filterDesign == Design_Matched)
+        CoefficientDesigner::makeMatchedLowPass(coefficients, sampleRate, chainSettings.highCutFreq, Q);
+    else
+        CoefficientDesigner::makeLowPass(coefficients, sampleRate, chainSettings.highCutFreq, Q);
+}
+
+static bool isLowCutTransparent(const ChainSettings& chainSettings)
+{
+    return chainSettings.lowCutBypass || chainSettings.lowCutFreq <= parkedLowCutFrequency;
+}
+
+static bool isHighCutTransparent(const ChainSettings& chainSettings)
+{
+    return chainSettings.highCutBypass || chainSettings.highCutFreq >= parkedHighCutFrequency;
+}
+
+static bool isBandTransparent(const ChainSettings& chainSettings, int band)
+{
+    const auto& settings = chainSettings.bands[static_cast<size_t>(band)];
+
+    if (settings.bypass)
+        return true;
+
+    // A dynamic band at 0 dB still cuts once the detector crosses the threshold
+    if (isBandDynamic(chainSettings, band))
+        return false;
+
+    // Notch and band-pass shapes do not depend on the gain reaching 0 dB
+    if (settings.type == Band_Notch || settings.type == Band_BandPass)
+        return false;
+
+    return std::abs(settings.gain) < transparentBandGainDb;
+}
+
+bool isBandDynamic(const ChainSettings& chainSettings, int band)
+{
+    const auto& settings = chainSettings.bands[static_cast<size_t>(band)];
+
+    return !settings.bypass
+        && settings.type == Band_Bell
+        && settings.dynamics.enabled;
+}
+
+bool isBandStateVariable(const ChainSettings& chainSettings, int band)
+{
+    const auto& settings = chainSettings.bands[static_cast<size_t>(band)];
+
+    return !isBandTransparent(chainSettings, band)
+        && !isBandDynamic(chainSettings, band)
+        && settings.type != Band_Tilt
+        && (settings.modulation.isActive() || chainSettings.filterEngine == Engine_StateVariable);
+}
+
+template <typename SampleType>
+static typename BiquadCascade<SampleType>::ChannelMode getCascadeChannelMode(StereoMode stereoMode)
+{
+    using ChannelMode = typename BiquadCascade<SampleType>::ChannelMode;
+
+    switch (stereoMode)
+    {
+        case Stereo_DualMono:   return ChannelMode::Split;
+        case Stereo_MidSide:    return ChannelMode::MidSide;
+        case Stereo_Linked:
+        default:                return ChannelMode::Shared;
+    }
+}
+
+// Fills the second channel's set of a section whose first set was just
+// designed, so the design itself runs once whatever the placement
+template <typename SampleType>
+static void placeSection(BiquadCascade<SampleType>& cascade, int section, BandPlacement placement)
+{
+    if (cascade.getChannelMode() == BiquadCascade<SampleType>::ChannelMode::Shared)
+        return;
+
+    auto* first = cascade.getCoefficients(section, 0);
+    auto* second = cascade.getCoefficients(section, 1);
+
+    if (placement == Placement_First) {
+        CoefficientDesigner::makeIdentity(second);
+        return;
+    }
+
+    std::copy(first, first + CoefficientDesigner::biquadSize, second);
+
+    if (placement == Placement_Second)
+        CoefficientDesigner::makeIdentity(first);
+}
+
+template <typename SampleType>
+void updateCascade(BiquadCascade<SampleType>& cascade, const ChainSettings& chainSettings, double sampleRate, int dirtyStages)
+{
+    // A mode change dirties every stage, so all sets get refilled below
+    cascade.setChannelMode(getCascadeChannelMode<SampleType>(chainSettings.stereoMode));
+
+    // Sections of transparent stages, and of stages on the state-variable
+    // engine, are switched out without being redesigned, so they keep their
+    // last coefficients while fading out
+    const bool areCutsStateVariable = chainSettings.filterEngine == Engine_StateVariable;
+
+    if (dirtyStages & stageBit(LowCut)) {
+        const bool isTransparent = isLowCutTransparent(chainSettings) || areCutsStateVariable;
 
-    if(index == 0)
-		params = { sampleRate, chainSettings.band1Freq, chainSettings.band1Q, chainSettings.band1Gain };
-    else if (index == 1)
-        params = { sampleRate, chainSettings.band2Freq, chainSettings.band2Q, chainSettings.band2Gain };
-    else if (index == 2)
-        params = { sampleRate, chainSettings.band3Freq, chainSettings.band3Q, chainSettings.band3Gain };
+        for (int i = 0; i < maxCutSections; ++i) {
+            const bool isActive = !isTransparent && i <= chainSettings.lowCutSlope;
 
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(params.rate, params.frequency, params.Q, juce::Decibels::decibelsToGain(params.dBGain));
+            if (isActive) {
+                designLowCutSection(cascade.getCoefficients(LowCutFirstSection + i), chainSettings, sampleRate, i);
+                placeSection(cascade, LowCutFirstSection + i, Placement_Both);
+            }
+
+            cascade.setActive(LowCutFirstSection + i, isActive);
+        }
+    }
+
+    for (int i = 0; i < chainSettings.numBands; ++i) {
+        if ((dirtyStages & stageBit(bandPosition(i))) == 0)
+            continue;
+
+        const bool isActive = !isBandTransparent(chainSettings, i) && !isBandStateVariable(chainSettings, i);
+
+        if (isActive) {
+            designBandFilter(cascade.getCoefficients(FirstBandSection + i), chainSettings, sampleRate, i);
+            placeSection(cascade, FirstBandSection + i, chainSettings.bands[static_cast<size_t>(i)].placement);
+        }
+
+        cascade.setActive(FirstBandSection + i, isActive);
+    }
+
+    if (dirtyStages & stageBit(HighCut)) {
+        const bool isTransparent = isHighCutTransparent(chainSettings) || areCutsStateVariable;
+
+        for (int i = 0; i < maxCutSections; ++i) {
+            const bool isActive = !isTransparent && i <= chainSettings.highCutSlope;
+
+            if (isActive) {
+                designHighCutSection(cascade.getCoefficients(HighCutFirstSection + i), chainSettings, sampleRate, i);
+                placeSection(cascade, HighCutFirstSection + i, Placement_Both);
+            }
+
+            cascade.setActive(HighCutFirstSection + i, isActive);
+        }
+    }
 }
-juce::ReferenceCountedArray<IIRCoefficients> makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
 
+template void updateCascade<float>(BiquadCascade<float>&, const ChainSettings&, double, int);
+template void updateCascade<double>(BiquadCascade<double>&, const ChainSettings&, double, int);
+
+static StateVariableFilter::Type getStateVariableType(BandType type)
+{
+    switch (type)
+    {
+        case Band_LowShelf:     return StateVariableFilter::Type::LowShelf;
+        case Band_HighShelf:    return StateVariableFilter::Type::HighShelf;
+        case Band_Notch:        return StateVariableFilter::Type::Notch;
+        case Band_BandPass:     return StateVariableFilter::Type::BandPass;
+        case Band_Bell:
+        case Band_Tilt:
+        default:                return StateVariableFilter::Type::Bell;
+    }
+}
+
+template <typename SampleType>
+void updateModulatedBands(ModulatedBands<SampleType>& modulatedBands, const ChainSettings& chainSettings)
+{
+    using Cut = typename ModulatedBands<SampleType>::Cut;
+
+    const bool isLinked = chainSettings.stereoMode == Stereo_Linked;
+    modulatedBands.setMidSide(chainSettings.stereoMode == Stereo_MidSide);
+
+    // The cuts use the same section Qs as in the cascade. Their matched
+    // design has no state-variable form, like the matched peak.
+    const bool areCutsStateVariable = chainSettings.filterEngine == Engine_StateVariable;
+    const bool isLowCutActive = areCutsStateVariable && !isLowCutTransparent(chainSettings);
+    const bool isHighCutActive = areCutsStateVariable && !isHighCutTransparent(chainSettings);
+
+    for (int i = 0; i < maxCutSections; ++i) {
+        const bool isLowCutSectionActive = isLowCutActive && i <= chainSettings.lowCutSlope;
+        const bool isHighCutSectionActive = isHighCutActive && i <= chainSettings.highCutSlope;
+
+        modulatedBands.setCutSection(Cut::Low, i, isLowCutSectionActive, chainSettings.lowCutFreq,
+            isLowCutSectionActive ? static_cast<float>(getCutSectionQ(chainSettings.lowCutSlope, chainSettings.lowCutAlignment, i)) : 1.0f);
+        modulatedBands.setCutSection(Cut::High, i, isHighCutSectionActive, chainSettings.highCutFreq,
+            isHighCutSectionActive ? static_cast<float>(getCutSectionQ(chainSettings.highCutSlope, chainSettings.highCutAlignment, i)) : 1.0f);
+    }
+
+    for (int i = 0; i < chainSettings.numBands; ++i) {
+        const auto& band = chainSettings.bands[static_cast<size_t>(i)];
+        const int channel = (isLinked || band.placement == Placement_Both) ? -1 : (band.placement == Placement_First ? 0 : 1);
+
+        modulatedBands.setBand(i, isBandStateVariable(chainSettings, i), getStateVariableType(band.type),
+            band.freq, band.gain, band.Q, band.modulation, channel);
+    }
+}
+
+template void updateModulatedBands<float>(ModulatedBands<float>&, const ChainSettings&);
+template void updateModulatedBands<double>(ModulatedBands<double>&, const ChainSettings&);
+
+template <typename SampleType>
+void updateDynamicBands(DynamicBands<SampleType>& dynamicBands, const ChainSettings& chainSettings, double sampleRate)
+{
+    for (int i = 0; i < chainSettings.numBands; ++i) {
+        const auto& band = chainSettings.bands[static_cast<size_t>(i)];
+
+        dynamicBands.setBand(i, isBandDynamic(chainSettings, i), band.freq, band.Q, band.gain, band.dynamics, sampleRate);
+    }
+}
+
+template void updateDynamicBands<float>(DynamicBands<float>&, const ChainSettings&, double);
+template void updateDynamicBands<double>(DynamicBands<double>&, const ChainSettings&, double);
+
+template <typename SampleType>
+void updateDynamicSections(BiquadCascade<SampleType>& cascade, const DynamicBands<SampleType>& dynamicBands, const ChainSettings& chainSettings)
+{
+    for (int i = 0; i < chainSettings.numBands; ++i) {
+        if (!dynamicBands.isActive(i))
+            continue;
+
+        dynamicBands.designSection(i, cascade.getCoefficients(FirstBandSection + i));
+        placeSection(cascade, FirstBandSection + i, chainSettings.bands[static_cast<size_t>(i)].placement);
+    }
+}
+
+template void updateDynamicSections<float>(BiquadCascade<float>&, const DynamicBands<float>&, const ChainSettings&);
+template void updateDynamicSections<double>(BiquadCascade<double>&, const DynamicBands<double>&, const ChainSettings&);
+
+void interpolateSettings(ChainSettings& result, const ChainSettings& from, const ChainSettings& to, float amount)
+{
+    auto lerp = [amount](float a, float b) { return a + (b - a) * amount; };
+    auto logLerp = [amount](float a, float b) { return a * std::pow(b / a, amount); };
+
+    // Switches and choices flip halfway
+    result = amount < 0.5f ? from : to;
+
+    // A bypassed cut filter moves from or to its parked frequency
+    result.lowCutFreq = logLerp(from.lowCutBypass ? parkedLowCutFrequency : from.lowCutFreq,
+                                to.lowCutBypass ? parkedLowCutFrequency : to.lowCutFreq);
+    result.lowCutBypass = from.lowCutBypass && to.lowCutBypass;
+
+    result.highCutFreq = logLerp(from.highCutBypass ? parkedHighCutFrequency : from.highCutFreq,
+                                 to.highCutBypass ? parkedHighCutFrequency : to.highCutFreq);
+    result.highCutBypass = from.highCutBypass && to.highCutBypass;
+
+    // Shapes that vanish at 0 dB fade in or out from there when the band is
+    // bypassed on one side; notch and band-pass bands switch halfway instead
+    auto fadesThroughZero = [](const BandSettings& band) {
+        return band.type != Band_Notch && band.type != Band_BandPass;
+    };
+
+    for (size_t i = 0; i < static_cast<size_t>(result.numBands); ++i) {
+        auto a = from.bands[i];
+        auto b = to.bands[i];
+
+        if (a.bypass && !b.bypass && fadesThroughZero(b)) {
+            a = b;
+            a.gain = 0.0f;
+        }
+        else if (b.bypass && !a.bypass && fadesThroughZero(a)) {
+            b = a;
+            b.gain = 0.0f;
+        }
+
+        auto& band = result.bands[i];
+        band = amount < 0.5f ? a : b;
+
+        band.freq = logLerp(a.freq, b.freq);
+        band.gain = lerp(a.gain, b.gain);
+        band.Q = logLerp(a.Q, b.Q);
+
+        band.modulation.lfoRate = logLerp(a.modulation.lfoRate, b.modulation.lfoRate);
+        band.modulation.lfoDepth = lerp(a.modulation.lfoDepth, b.modulation.lfoDepth);
+        band.modulation.envelopeDepth = lerp(a.modulation.envelopeDepth, b.modulation.envelopeDepth);
+
+        band.dynamics.threshold = lerp(a.dynamics.threshold, b.dynamics.threshold);
+        band.dynamics.ratio = lerp(a.dynamics.ratio, b.dynamics.ratio);
+        band.dynamics.attack = logLerp(a.dynamics.attack, b.dynamics.attack);
+        band.dynamics.release = logLerp(a.dynamics.release, b.dynamics.release);
+    }
 }
-juce::ReferenceCountedArray<IIRCoefficients> makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate) {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2 * (chainSettings.highCutSlope + 1));
+
+int getDirtyStages(const ChainSettings& current, const ChainSettings& previous)
+{
+    int dirtyStages = 0;
+
+    if (current.lowCutFreq != previous.lowCutFreq
+        || current.lowCutSlope != previous.lowCutSlope
+        || current.lowCutAlignment != previous.lowCutAlignment
+        || current.lowCutBypass != previous.lowCutBypass)
+        dirtyStages |= stageBit(LowCut);
+
+    for (int i = 0; i < juce::jmax(current.numBands, previous.numBands); ++i) {
+        const auto& band = current.bands[static_cast<size_t>(i)];
+        const auto& previousBand = previous.bands[static_cast<size_t>(i)];
+
+        if (band.freq != previousBand.freq
+            || band.gain != previousBand.gain
+            || band.Q != previousBand.Q
+            || band.bypass != previousBand.bypass
+            || band.type != previousBand.type
+            || band.placement != previousBand.placement
+            || band.modulation.isActive() != previousBand.modulation.isActive()
+            || band.dynamics.enabled != previousBand.dynamics.enabled)
+            dirtyStages |= stageBit(bandPosition(i));
+    }
+
+    if (current.highCutFreq != previous.highCutFreq
+        || current.highCutSlope != previous.highCutSlope
+        || current.highCutAlignment != previous.highCutAlignment
+        || current.highCutBypass != previous.highCutBypass)
+        dirtyStages |= stageBit(HighCut);
+
+    // The low cut always uses the bilinear design: it is accurate that far
+    // from Nyquist. Only bell bands have a matched design, but redesigning
+    // the rest once is cheaper than tracking which are bells.
+    if (current.filterDesign != previous.filterDesign) {
+        dirtyStages |= stageBit(HighCut);
+
+        for (int i = 0; i < current.numBands; ++i)
+            dirtyStages |= stageBit(bandPosition(i));
+    }
+
+    // Every stage moves between the cascade and the state-variable engine
+    if (current.filterEngine != previous.filterEngine) {
+        dirtyStages |= stageBit(LowCut) | stageBit(HighCut);
+
+        for (int i = 0; i < current.numBands; ++i)
+            dirtyStages |= stageBit(bandPosition(i));
+    }
+
+    // Every section's second coefficient set changes meaning
+    if (current.stereoMode != previous.stereoMode) {
+        dirtyStages |= stageBit(LowCut) | stageBit(HighCut);
+
+        for (int i = 0; i < current.numBands; ++i)
+            dirtyStages |= stageBit(bandPosition(i));
+    }
+
+    return dirtyStages;
 }
 
 //==============================================================================
-SimpleEQAudioProcessor::SimpleEQAudioProcessor()
+SimpleEQAudioProcessor::SimpleEQAudioProcessor(int numBandsToUse)
 #ifndef JucePlugin_PreferredChannelConfigurations
      : AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       )
+                       ),
+#else
+     :
 #endif
+       numBands(juce::jlimit(1, maxBands, numBandsToUse))
 {
+    cacheParameterHandles();
+    cacheStateEntries();
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    // Hosts may destroy a prepared processor without releaseResources; the
+    // designer thread must stop before anything it reads goes
+    linearPhase.release();
+}
+
+void SimpleEQAudioProcessor::cacheParameterHandles()
+{
+    auto getHandle = [this](const juce::String& parameterId)
+        {
+            auto* handle = treeState.getRawParameterValue(parameterId);
+            jassert(handle != nullptr);
+            return handle;
+        };
+
+    lowCutHandles.frequency = getHandle("LowCut Frequency");
+    lowCutHandles.slope = getHandle("LowCut Slope");
+    lowCutHandles.alignment = getHandle("LowCut Type");
+    lowCutHandles.bypass = getHandle("LowCut Bypass");
+
+    highCutHandles.frequency = getHandle("HighCut Frequency");
+    highCutHandles.slope = getHandle("HighCut Slope");
+    highCutHandles.alignment = getHandle("HighCut Type");
+    highCutHandles.bypass = getHandle("HighCut Bypass");
+
+    for (int i = 0; i < numBands; ++i) {
+        juce::String BandId = "Band" + std::to_string(i + 1);
+        auto& handles = bandHandles[static_cast<size_t>(i)];
+
+        handles.frequency = getHandle(BandId + " Frequency");
+        handles.gain = getHandle(BandId + " Gain");
+        handles.quality = getHandle(BandId + " Quality");
+        handles.bypass = getHandle(BandId + " Bypass");
+        handles.type = getHandle(BandId + " Type");
+        handles.placement = getHandle(BandId + " Channel");
+        handles.lfoRate = getHandle(BandId + " LFO Rate");
+        handles.lfoDepth = getHandle(BandId + " LFO Depth");
+        handles.envelopeDepth = getHandle(BandId + " Env Depth");
+        handles.dynamic = getHandle(BandId + " Dynamic");
+        handles.threshold = getHandle(BandId + " Threshold");
+        handles.ratio = getHandle(BandId + " Ratio");
+        handles.attack = getHandle(BandId + " Attack");
+        handles.release = getHandle(BandId + " Release");
+    }
+
+    phaseModeHandle = getHandle("Phase Mode");
+    kernelLengthHandle = getHandle("Linear Phase Length");
+    oversamplingHandle = getHandle("Oversampling");
+    filterDesignHandle = getHandle("Filter Design");
+    filterEngineHandle = getHandle("Filter Engine");
+    controlRateHandle = getHandle("Control Rate");
+    stereoModeHandle = getHandle("Stereo Mode");
+    sidechainHandle = getHandle("Sidechain");
+    morphHandle = getHandle("Morph");
+    morphEnabledHandle = getHandle("Morph Enabled");
+}
+
+int SimpleEQAudioProcessor::getLinearPhaseKernelLength() const
+{
+    return LinearPhaseFilter::minimumKernelLength << juce::roundToInt(kernelLengthHandle->load());
+}
+
+int SimpleEQAudioProcessor::getOversamplingOrder() const
+{
+    if (phaseModeHandle->load() >= 0.5f)
+        return 0;
+
+    return juce::jlimit(0, maxOversamplingOrder, juce::roundToInt(oversamplingHandle->load()));
+}
+
+FilterEngine SimpleEQAudioProcessor::getFilterEngine() const
+{
+    if (phaseModeHandle->load() >= 0.5f)
+        return Engine_Biquad;
+
+    return static_cast<FilterEngine>(juce::roundToInt(filterEngineHandle->load()));
+}
+
+double SimpleEQAudioProcessor::getFilterSampleRate() const
+{
+    return getSampleRate() * (1 << getOversamplingOrder());
+}
+
+int SimpleEQAudioProcessor::getCurrentLatencySamples()
+{
+    if (bLinearPhase)
+        return linearPhase.getLatencySamples();
+
+    if (oversamplingOrder == 0)
+        return 0;
+
+    const auto index = static_cast<size_t>(oversamplingOrder - 1);
+
+    // The oversamplers use integer latency, so rounding loses nothing
+    if (isUsingDoublePrecision())
+        return juce::roundToInt(doubleOversamplers[index]->getLatencyInSamples());
+
+    return juce::roundToInt(oversamplers[index]->getLatencyInSamples());
+}
+
+int SimpleEQAudioProcessor::getControlInterval() const
+{
+    return minControlInterval << juce::roundToInt(controlRateHandle->load());
+}
+
+void SimpleEQAudioProcessor::resetSmoothers(const ChainSettings& chainSettings, double sampleRate)
+{
+    lowCutSmoother.reset(sampleRate, smoothingSeconds);
+    lowCutSmoother.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    morphSmoother.reset(sampleRate, smoothingSeconds);
+    morphSmoother.setCurrentAndTargetValue(morphHandle->load());
+    highCutSmoother.reset(sampleRate, smoothingSeconds);
+    highCutSmoother.setCurrentAndTargetValue(chainSettings.highCutFreq);
+
+    for (size_t i = 0; i < static_cast<size_t>(numBands); ++i) {
+        const auto& band = chainSettings.bands[i];
+        auto& smoothers = bandSmoothers[i];
+
+        smoothers.frequency.reset(sampleRate, smoothingSeconds);
+        smoothers.frequency.setCurrentAndTargetValue(band.freq);
+        smoothers.gain.reset(sampleRate, smoothingSeconds);
+        smoothers.gain.setCurrentAndTargetValue(band.gain);
+        smoothers.quality.reset(sampleRate, smoothingSeconds);
+        smoothers.quality.setCurrentAndTargetValue(band.Q);
+    }
+}
+
+ChainSettings SimpleEQAudioProcessor::getSmoothedSettings(const ChainSettings& targetSettings, int numSamples)
+{
+    // Switches, slopes and the design method change immediately; the cascade
+    // crossfades sections switched in or out
+    auto settings = targetSettings;
+
+    auto advance = [numSamples](auto& smoother, float target)
+        {
+            smoother.setTargetValue(target);
+            return smoother.skip(numSamples);
+        };
+
+    settings.lowCutFreq = advance(lowCutSmoother, targetSettings.lowCutFreq);
+    settings.highCutFreq = advance(highCutSmoother, targetSettings.highCutFreq);
+
+    for (size_t i = 0; i < static_cast<size_t>(numBands); ++i) {
+        const auto& target = targetSettings.bands[i];
+        auto& band = settings.bands[i];
+        auto& smoothers = bandSmoothers[i];
+
+        band.freq = advance(smoothers.frequency, target.freq);
+        band.gain = advance(smoothers.gain, target.gain);
+        band.Q = advance(smoothers.quality, target.Q);
+    }
+
+    return settings;
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::prepareOversamplers(int numChannels, int samplesPerBlock)
+{
+    using Oversampling = juce::dsp::Oversampling<SampleType>;
+
+    auto& stages = getOversamplers<SampleType>();
+
+    for (int order = 1; order <= maxOversamplingOrder; ++order) {
+        auto& oversampler = stages[static_cast<size_t>(order - 1)];
+        oversampler = std::make_unique<Oversampling>(static_cast<size_t>(numChannels), static_cast<size_t>(order),
+            Oversampling::filterHalfBandPolyphaseIIR, true, true);
+        oversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
+    }
 }
 
 //==============================================================================
@@ -91,7 +636,11 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The linear-phase kernel already contains the truncated IIR tail
+    if (phaseModeHandle->load() >= 0.5f && getSampleRate() > 0.0)
+        return getLinearPhaseKernelLength() / getSampleRate();
+
+    return tailLengthSeconds.load();
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -125,20 +674,65 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // initialisation that you need..
 
     juce::dsp::ProcessSpec spec;
-    spec.numChannels = 1;
-    spec.maximumBlockSize = samplesPerBlock;
+    spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
+    spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    oversamplingOrder = getOversamplingOrder();
+
+    // The cascade sees blocks at up to the highest oversampled length, and
+    // runs at the oversampled rate
+    auto cascadeSpec = spec;
+    cascadeSpec.maximumBlockSize <<= maxOversamplingOrder;
+    cascadeSpec.sampleRate = sampleRate * (1 << oversamplingOrder);
+
+    liveCascade = 0;
+    crossfadeRemaining = 0;
+
+    if (isUsingDoublePrecision()) {
+        for (auto& doubleCascade : doubleCascades)
+            doubleCascade.prepare(cascadeSpec, NumCascadeSections);
 
-    updateFilters();
+        doubleCrossfadeBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(cascadeSpec.maximumBlockSize));
+        doubleModulatedBands.prepare(spec, numBands, maxCutSections);
+        doubleDynamicBands.prepare(spec, numBands);
+        prepareOversamplers<double>(getTotalNumOutputChannels(), samplesPerBlock);
+    }
+    else {
+        for (auto& cascade : cascades)
+            cascade.prepare(cascadeSpec, NumCascadeSections);
+
+        crossfadeBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(cascadeSpec.maximumBlockSize));
+        modulatedBands.prepare(spec, numBands, maxCutSections);
+        dynamicBands.prepare(spec, numBands);
+        prepareOversamplers<float>(getTotalNumOutputChannels(), samplesPerBlock);
+    }
+
+    linearPhase.setKernelLength(getLinearPhaseKernelLength());
+    linearPhase.prepare(spec);
+
+    leftChannelFifo.setDecimation(SampleFifo::getDecimationFor(sampleRate));
+
+    bLinearPhase = phaseModeHandle->load() >= 0.5f;
+    linearPhase.setEnabled(bLinearPhase);
+    setLatencySamples(getCurrentLatencySamples());
+
+    const auto chainSettings = getChainSettings();
+    resetSmoothers(chainSettings, sampleRate);
+
+    // Forces every stage to be redesigned for the new sample rate
+    appliedSampleRate = 0.0;
+    updateFilters(chainSettings);
+
+    silentSamples = 0;
+    isIdle = false;
 }
 
 void SimpleEQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    linearPhase.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -148,12 +742,9 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout works, from mono up to immersive beds: every channel gets
+    // its own filter state and they are processed in SIMD batches.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -162,12 +753,31 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
         return false;
    #endif
 
+    // The sidechain is mixed down to one detector signal, so it can have
+    // any layout, or be disabled
+
     return true;
   #endif
 }
 #endif
 
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+bool SimpleEQAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -182,20 +792,274 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateFilters();
+    auto& activeOversamplers = getOversamplers<SampleType>();
+    auto& activeModulatedBands = getModulatedBands<SampleType>();
+    auto& activeDynamicBands = getDynamicBands<SampleType>();
+
+    const bool shouldUseLinearPhase = phaseModeHandle->load() >= 0.5f;
+    linearPhase.setKernelLength(getLinearPhaseKernelLength());
+    linearPhase.setEnabled(shouldUseLinearPhase);
+
+    if (shouldUseLinearPhase != bLinearPhase) {
+        // The path being switched in has been idle, so its state is stale.
+        // The cascade keeps running into linear phase if it has to bridge.
+        bLinearPhase = shouldUseLinearPhase;
+
+        if (bLinearPhase)
+            linearPhase.reset();
+        else
+            getCascade<SampleType>().reset();
+    }
+
+    const int newOversamplingOrder = getOversamplingOrder();
+
+    if (newOversamplingOrder != oversamplingOrder) {
+        // The cascade gets redesigned for the new rate below
+        oversamplingOrder = newOversamplingOrder;
+        getCascade<SampleType>().reset();
+
+        for (auto& cascade : getCascades<SampleType>())
+            cascade.setSampleRate(getSampleRate() * (1 << oversamplingOrder));
+
+        for (auto& oversampler : activeOversamplers)
+            oversampler->reset();
+    }
+
+    // A recall arriving during another's crossfade waits for it to finish
+    if (crossfadeRemaining == 0) {
+        if (auto* recall = recalls.take()) {
+            applyRecall<SampleType>(recall->object);
+            Handoff<ChainRecall>::release(recall);
+        }
+    }
+
+    auto& activeCascade = getCascade<SampleType>();
+
+    // The table being replaced is not read again
+    if (auto* table = morphTables.take()) {
+        Handoff<MorphTable>::release(morphTable);
+        morphTable = table;
+    }
+
+    morphSmoother.setTargetValue(morphHandle->load());
+
+    // While morphing, the snapshots replace the parameters. Switches and
+    // choices follow the morph position at the start of the block.
+    const bool isMorphing = morphEnabledHandle->load() >= 0.5f && morphTable != nullptr && morphTable->object.numStates >= 2;
+    const auto targetSettings = isMorphing ? ChainSettings(getMorphedSettings(0)) : getChainSettings();
+    const int numSamples = buffer.getNumSamples();
+
+    linearPhase.setMidSide(targetSettings.stereoMode == Stereo_MidSide);
+
+    const int latencySamples = getCurrentLatencySamples();
+    if (latencySamples != getLatencySamples())
+        setLatencySamples(latencySamples);
+
+    if (isInputSilent(buffer)) {
+        silentSamples = juce::jmin(silentSamples + buffer.getNumSamples(), std::numeric_limits<int>::max() - buffer.getNumSamples());
+    }
+    else {
+        silentSamples = 0;
+        isIdle = false;
+    }
+
+    const int tailSamples = bLinearPhase ? linearPhase.getKernelLength() : tailLengthSamples + latencySamples;
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    const auto stateMagnitude = juce::jmax(activeCascade.getStateMagnitude(), activeModulatedBands.getStateMagnitude());
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    if (!isIdle && silentSamples > tailSamples && stateMagnitude < silenceThreshold) {
+        isIdle = true;
+        activeCascade.reset();
+        activeModulatedBands.reset();
+        activeDynamicBands.reset();
+        linearPhase.reset();
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+        for (auto& oversampler : activeOversamplers)
+            oversampler->reset();
+    }
+
+    // The buffer also carries the sidechain's channels when it is enabled
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, static_cast<size_t>(totalNumOutputChannels));
+
+    // Dynamic bands listen to the unfiltered main input, or to the sidechain
+    // when it is connected and selected
+    auto detectorBlock = block;
+    const int numSidechainChannels = getChannelCountOfBus(true, 1);
+
+    if (targetSettings.externalSidechain && numSidechainChannels > 0)
+        detectorBlock = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(
+            static_cast<size_t>(getChannelIndexInProcessBlockBuffer(true, 1, 0)), static_cast<size_t>(numSidechainChannels));
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    // Until the linear-phase kernel is in, the cascade stands in for it
+    const bool isBridging = bLinearPhase && linearPhase.isBridging();
 
-    leftChannelFifo.push(buffer.getReadPointer(0), buffer.getNumSamples());
+    if (isIdle || (bLinearPhase && !isBridging)) {
+        // Nothing to step through: apply the smoothed settings once. The
+        // linear-phase kernel is redesigned in the background from them.
+        updateFilters(getSmoothedSettings(isMorphing ? getMorphedSettings(numSamples) : targetSettings, numSamples));
+        updateModulatedBands(activeModulatedBands, appliedSettings);
+        updateDynamicBands(activeDynamicBands, appliedSettings, appliedSampleRate);
+
+        if (isIdle) {
+            buffer.clear();
+        }
+        else {
+            juce::dsp::ProcessContextReplacing<SampleType> context(block);
+            activeModulatedBands.followEnvelope(block);
+            linearPhase.process(context);
+            activeModulatedBands.process(context);
+        }
+    }
+    else {
+        const int controlInterval = getControlInterval();
+
+        if (isBridging) {
+            linearPhase.beginBridge(block);
+            activeModulatedBands.followEnvelope(block);
+        }
+
+        for (int start = 0; start < numSamples; start += controlInterval) {
+            const int subBlockLength = juce::jmin(controlInterval, numSamples - start);
+
+            updateFilters(getSmoothedSettings(isMorphing ? getMorphedSettings(subBlockLength) : targetSettings, subBlockLength));
+            updateModulatedBands(activeModulatedBands, appliedSettings);
+            updateDynamicBands(activeDynamicBands, appliedSettings, appliedSampleRate);
+
+            // The detectors see the block before it is filtered, so its gain
+            // reduction applies without a control block of lag
+            if (activeDynamicBands.isProcessing()) {
+                activeDynamicBands.process(detectorBlock.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(subBlockLength)));
+                updateDynamicSections(activeCascade, activeDynamicBands, appliedSettings);
+            }
+
+            auto subBlock = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(subBlockLength));
+            juce::dsp::ProcessContextReplacing<SampleType> context(subBlock);
+
+            // Envelopes follow the input, not what the EQ makes of it
+            if (!isBridging)
+                activeModulatedBands.followEnvelope(subBlock);
+
+            if (oversamplingOrder > 0) {
+                auto& oversampler = *activeOversamplers[static_cast<size_t>(oversamplingOrder - 1)];
+                auto oversampledBlock = oversampler.processSamplesUp(subBlock);
+                processCascade(oversampledBlock);
+                oversampler.processSamplesDown(subBlock);
+            }
+            else {
+                processCascade(subBlock);
+            }
+
+            if (!isBridging)
+                activeModulatedBands.process(context);
+        }
+
+        // Modulated bands filter the delayed signal, as they filter the
+        // convolution once it takes over
+        if (isBridging) {
+            juce::dsp::ProcessContextReplacing<SampleType> context(block);
+            linearPhase.finishBridge(context);
+            activeModulatedBands.process(context);
+        }
+    }
+
+    processedBlockCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Nobody sees the analyser during offline bounces or with editors closed
+    if (leftChannelFifo.hasConsumer() && !isNonRealtime())
+        leftChannelFifo.push(buffer.getReadPointer(0), buffer.getNumSamples());
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::processCascade(juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& live = getCascade<SampleType>();
+
+    if (crossfadeRemaining == 0) {
+        live.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+        return;
+    }
+
+    auto& outgoing = getCascades<SampleType>()[static_cast<size_t>(liveCascade ^ 1)];
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+
+    auto outgoingBlock = juce::dsp::AudioBlock<SampleType>(getCrossfadeBuffer<SampleType>())
+        .getSubsetChannelBlock(0, numChannels)
+        .getSubBlock(0, block.getNumSamples());
+    outgoingBlock.copyFrom(block);
+
+    outgoing.process(juce::dsp::ProcessContextReplacing<SampleType>(outgoingBlock));
+    live.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+
+    const auto fadeSamples = juce::jmin(numSamples, crossfadeRemaining);
+    const auto step = SampleType(1) / static_cast<SampleType>(crossfadeLength);
+    const auto startGain = SampleType(1) - static_cast<SampleType>(crossfadeRemaining) * step;
+
+    for (size_t channel = 0; channel < numChannels; ++channel) {
+        auto* samples = block.getChannelPointer(channel);
+        const auto* outgoingSamples = outgoingBlock.getChannelPointer(channel);
+
+        for (int i = 0; i < fadeSamples; ++i) {
+            const auto gain = startGain + static_cast<SampleType>(i) * step;
+            samples[i] = outgoingSamples[i] + (samples[i] - outgoingSamples[i]) * gain;
+        }
+    }
+
+    crossfadeRemaining -= fadeSamples;
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::applyRecall(const ChainRecall& recall)
+{
+    auto& cascades = getCascades<SampleType>();
+    const double filterSampleRate = getSampleRate() * (1 << oversamplingOrder);
+
+    const int outgoing = liveCascade;
+    liveCascade ^= 1;
+    auto& incoming = cascades[static_cast<size_t>(liveCascade)];
+
+    const BiquadCascade<SampleType>* design = nullptr;
+
+    if constexpr (std::is_same_v<SampleType, double>)
+        design = &recall.doubleDesign;
+    else
+        design = &recall.design;
+
+    if (recall.sampleRate == filterSampleRate
+        && design->getNumSections() == incoming.getNumSections()
+        && design->getNumChannels() == incoming.getNumChannels()) {
+        incoming.loadDesign(*design);
+    }
+    else {
+        // Designed for another rate or layout, or before prepareToPlay: start
+        // from the live design and redesign every stage, still allocation-free
+        incoming.loadDesign(cascades[static_cast<size_t>(outgoing)]);
+        updateCascade(incoming, recall.settings, filterSampleRate, stageBit(bandPosition(numBands)) - 1);
+    }
+
+    // The smoothers start at the recalled values, so nothing glides
+    resetSmoothers(recall.settings, getSampleRate());
+    appliedSettings = recall.settings;
+    appliedSampleRate = filterSampleRate;
+
+    tailLengthSamples = incoming.getTailLengthSamples(silenceThreshold) >> oversamplingOrder;
+    tailLengthSeconds.store(tailLengthSamples / getSampleRate());
+    settingsVersion.fetch_add(1);
+    publishAppliedSettings();
+
+    // Nothing is heard from the cascade while idle or in linear-phase mode
+    crossfadeLength = juce::jmax(1, juce::roundToInt(crossfadeSeconds * filterSampleRate));
+    crossfadeRemaining = (isIdle || bLinearPhase) ? 0 : crossfadeLength;
+}
+
+template <typename SampleType>
+bool SimpleEQAudioProcessor::isInputSilent(const juce::AudioBuffer<SampleType>& buffer) const
+{
+    for (int channel = 0; channel < getMainBusNumInputChannels(); ++channel)
+        if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) >= silenceThreshold)
+            return false;
+
+    return true;
 }
 
 //==============================================================================
@@ -219,7 +1083,28 @@ void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 
     //stores the params value in order to start it in next execution
     juce::MemoryOutputStream mos(destData, true);
-    treeState.state.writeToStream(mos);
+
+    // Entries that could not be told apart would load into the wrong
+    // parameters; the ValueTree is slower but keeps the IDs
+    if (hasStateHashCollision) {
+        auto state = treeState.copyState();
+        state.appendChild(createSnapshotsTree(), nullptr);
+        state.writeToStream(mos);
+        return;
+    }
+
+    mos.preallocate(static_cast<size_t>(stateHeaderSize + stateEntrySize * static_cast<int>(stateEntries.size())));
+
+    mos.writeInt(stateMagic);
+    mos.writeInt(stateVersion);
+    mos.writeInt(static_cast<int>(stateEntries.size()));
+
+    for (const auto& entry : stateEntries) {
+        mos.writeInt(static_cast<int>(entry.idHash));
+        mos.writeFloat(entry.parameter->convertFrom0to1(entry.parameter->getValue()));
+    }
+
+    writeBinarySnapshots(mos);
 }
 
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -228,53 +1113,403 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     // whose contents will have been created by the getStateInformation() call.
 
     //restores last execution params values
+    if (sizeInBytes >= stateHeaderSize
+        && static_cast<int>(juce::ByteOrder::littleEndianInt(data)) == stateMagic) {
+        if (loadBinaryState(data, sizeInBytes)) {
+            publishRecall(getChainSettings());
+
+            // "Morph" and "Morph Enabled" came back with the parameters; the
+            // table they morph across comes from the restored snapshots
+            publishMorphTable();
+        }
+
+        return;
+    }
+
+    // Sessions saved before the binary format, or with colliding hashes
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
-    if (tree.isValid()) {
-        treeState.replaceState(tree);
-        updateFilters();
+
+    if (!tree.isValid())
+        return;
+
+    const auto snapshotsTree = tree.getChildWithName("SNAPSHOTS");
+    tree.removeChild(snapshotsTree, nullptr);
+
+    // The chain is designed here and handed over to the audio thread, so
+    // the cascade it is running is never written from this thread
+    recallState(tree);
+    restoreSnapshots(snapshotsTree);
+    publishMorphTable();
+}
+
+juce::uint32 getParameterIdHash(const juce::String& parameterId)
+{
+    juce::uint32 hash = 0x811c9dc5;
+
+    for (auto* byte = parameterId.toRawUTF8(); *byte != 0; ++byte) {
+        hash ^= static_cast<juce::uint8>(*byte);
+        hash *= 0x01000193;
     }
+
+    return hash;
 }
 
-ChainSettings SimpleEQAudioProcessor::getChainSettings(juce::AudioProcessorValueTreeState& treeState) {
-    ChainSettings settings;
+void SimpleEQAudioProcessor::cacheStateEntries()
+{
+    for (auto* parameter : getParameters()) {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            stateEntries.push_back({ getParameterIdHash(ranged->paramID), ranged });
+    }
 
-    settings.lowCutFreq = treeState.getRawParameterValue("LowCut Frequency")->load();
-    settings.lowCutSlope = static_cast<Slope>(treeState.getRawParameterValue("LowCut Slope")->load());
-    settings.lowCutBypass = treeState.getRawParameterValue("LowCut Bypass")->load() < 0.5f;
+    std::sort(stateEntries.begin(), stateEntries.end(),
+        [](const StateEntry& a, const StateEntry& b) { return a.idHash < b.idHash; });
 
-    settings.highCutFreq = treeState.getRawParameterValue("HighCut Frequency")->load();
-    settings.highCutSlope = static_cast<Slope>(treeState.getRawParameterValue("HighCut Slope")->load());
-    settings.highCutBypass = treeState.getRawParameterValue("HighCut Bypass")->load() < 0.5f;
+    // Checked in every build: IDs whose hashes collide could not be told
+    // apart, so the state falls back to the ValueTree
+    hasStateHashCollision = std::adjacent_find(stateEntries.begin(), stateEntries.end(),
+        [](const StateEntry& a, const StateEntry& b) { return a.idHash == b.idHash; }) != stateEntries.end();
 
-    juce::String BandId;
-    for (int i = 1; i <= nBands; ++i) {
-        BandId = "Band" + std::to_string(i);
-        if (i == 1) 
-        {
-            settings.band1Freq = treeState.getRawParameterValue(BandId + " Frequency")->load();
-            settings.band1Gain = treeState.getRawParameterValue(BandId + " Gain")->load();
-            settings.band1Q = treeState.getRawParameterValue(BandId + " Quality")->load();
-            settings.band1Bypass = treeState.getRawParameterValue(BandId + " Bypass")->load() < 0.5f;
+    jassert(!hasStateHashCollision);
+
+    stateEntryLoaded.resize(stateEntries.size());
+}
+
+bool SimpleEQAudioProcessor::loadBinaryState(const void* data, int sizeInBytes)
+{
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+    stream.readInt();   // magic
+
+    // Versions are only ever added; a newer state leaves the settings alone
+    const auto version = stream.readInt();
+    const auto numEntries = stream.readInt();
+
+    if (version < 1 || version > stateVersion
+        || numEntries < 0 || stream.getNumBytesRemaining() < static_cast<juce::int64>(numEntries) * stateEntrySize)
+        return false;
+
+    std::fill(stateEntryLoaded.begin(), stateEntryLoaded.end(), 0);
+
+    auto byHash = [](const StateEntry& entry, juce::uint32 idHash) { return entry.idHash < idHash; };
+
+    for (int i = 0; i < numEntries; ++i) {
+        const auto idHash = static_cast<juce::uint32>(stream.readInt());
+        const auto value = stream.readFloat();
+
+        // Parameters this instance does not have are skipped
+        const auto it = std::lower_bound(stateEntries.begin(), stateEntries.end(), idHash, byHash);
+
+        if (it == stateEntries.end() || it->idHash != idHash)
+            continue;
+
+        it->parameter->setValueNotifyingHost(it->parameter->convertTo0to1(value));
+        stateEntryLoaded[static_cast<size_t>(it - stateEntries.begin())] = 1;
+    }
+
+    // As with replaceState, parameters missing from the state go back to
+    // their defaults
+    for (size_t i = 0; i < stateEntries.size(); ++i) {
+        if (!stateEntryLoaded[i]) {
+            auto* parameter = stateEntries[i].parameter;
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
         }
-        if (i == 2) 
-        {
-            settings.band2Freq = treeState.getRawParameterValue(BandId + " Frequency")->load();
-            settings.band2Gain = treeState.getRawParameterValue(BandId + " Gain")->load();
-            settings.band2Q = treeState.getRawParameterValue(BandId + " Quality")->load();
-            settings.band2Bypass = treeState.getRawParameterValue(BandId + " Bypass")->load() < 0.5f;
+    }
+
+    if (stream.getNumBytesRemaining() >= 2 * 4 && stream.readInt() == stateSnapshotTag)
+        readBinarySnapshots(stream);
+    else
+        clearSnapshots();
+
+    return true;
+}
+
+void SimpleEQAudioProcessor::setSnapshot(int slot, const juce::ValueTree& state)
+{
+    snapshots[static_cast<size_t>(slot)] = state;
+    snapshotSettings[static_cast<size_t>(slot)] = getChainSettings(state);
+}
+
+void SimpleEQAudioProcessor::clearSnapshots()
+{
+    for (auto& snapshot : snapshots)
+        snapshot = {};
+
+    selectedSnapshot = 0;
+}
+
+void SimpleEQAudioProcessor::writeBinarySnapshots(juce::OutputStream& stream) const
+{
+    // Nothing stored, nothing to write
+    if (std::none_of(snapshots.begin(), snapshots.end(), [](const juce::ValueTree& snapshot) { return snapshot.isValid(); })
+        && selectedSnapshot == 0)
+        return;
+
+    stream.writeInt(stateSnapshotTag);
+    stream.writeInt(selectedSnapshot);
+
+    for (const auto& snapshot : snapshots) {
+        if (!snapshot.isValid()) {
+            stream.writeInt(-1);
+            continue;
         }
-        if (i == 3)
-        {
-            settings.band3Freq = treeState.getRawParameterValue(BandId + " Frequency")->load();
-            settings.band3Gain = treeState.getRawParameterValue(BandId + " Gain")->load();
-            settings.band3Q = treeState.getRawParameterValue(BandId + " Quality")->load();
-            settings.band3Bypass = treeState.getRawParameterValue(BandId + " Bypass")->load() < 0.5f;
+
+        stream.writeInt(snapshot.getNumChildren());
+
+        for (const auto& child : snapshot) {
+            stream.writeInt(static_cast<int>(getParameterIdHash(child.getProperty("id").toString())));
+            stream.writeFloat(static_cast<float>(child.getProperty("value")));
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::readBinarySnapshots(juce::InputStream& stream)
+{
+    clearSnapshots();
+
+    const auto selected = stream.readInt();
+    std::vector<std::pair<juce::uint32, float>> entries;
+
+    for (int slot = 0; slot < numSnapshots; ++slot) {
+        // A truncated section keeps the slots read so far
+        if (stream.getNumBytesRemaining() < 4)
+            break;
+
+        const auto numEntries = stream.readInt();
+
+        if (numEntries < 0)
+            continue;
+
+        if (stream.getNumBytesRemaining() < static_cast<juce::int64>(numEntries) * stateEntrySize)
+            break;
+
+        entries.resize(static_cast<size_t>(numEntries));
+
+        for (auto& entry : entries) {
+            entry.first = static_cast<juce::uint32>(stream.readInt());
+            entry.second = stream.readFloat();
         }
+
+        std::sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        // Same layout as the parameters; what the entries leave out is at
+        // its default, as in loadBinaryState
+        auto state = treeState.copyState();
+
+        for (auto child : state) {
+            const auto id = child.getProperty("id").toString();
+            const auto idHash = getParameterIdHash(id);
+            const auto it = std::lower_bound(entries.begin(), entries.end(), idHash,
+                [](const std::pair<juce::uint32, float>& entry, juce::uint32 hash) { return entry.first < hash; });
+
+            if (it != entries.end() && it->first == idHash)
+                child.setProperty("value", it->second, nullptr);
+            else if (auto* parameter = treeState.getParameter(id))
+                child.setProperty("value", parameter->convertFrom0to1(parameter->getDefaultValue()), nullptr);
+        }
+
+        setSnapshot(slot, state);
+    }
+
+    selectedSnapshot = juce::jlimit(0, numSnapshots - 1, selected);
+}
+
+juce::ValueTree SimpleEQAudioProcessor::createSnapshotsTree() const
+{
+    juce::ValueTree snapshotsTree("SNAPSHOTS");
+    snapshotsTree.setProperty("selected", selectedSnapshot, nullptr);
+
+    for (int slot = 0; slot < numSnapshots; ++slot) {
+        if (!hasSnapshot(slot))
+            continue;
+
+        juce::ValueTree slotTree("SNAPSHOT");
+        slotTree.setProperty("slot", slot, nullptr);
+        slotTree.appendChild(snapshots[static_cast<size_t>(slot)].createCopy(), nullptr);
+        snapshotsTree.appendChild(slotTree, nullptr);
+    }
+
+    return snapshotsTree;
+}
+
+void SimpleEQAudioProcessor::restoreSnapshots(const juce::ValueTree& snapshotsTree)
+{
+    clearSnapshots();
+
+    for (const auto& slotTree : snapshotsTree) {
+        const int slot = slotTree.getProperty("slot", -1);
+
+        if (juce::isPositiveAndBelow(slot, numSnapshots) && slotTree.getNumChildren() > 0)
+            setSnapshot(slot, slotTree.getChild(0).createCopy());
+    }
+
+    selectedSnapshot = juce::jlimit(0, numSnapshots - 1, static_cast<int>(snapshotsTree.getProperty("selected", 0)));
+}
+
+void SimpleEQAudioProcessor::recallState(const juce::ValueTree& state)
+{
+    treeState.replaceState(state.createCopy());
+    publishRecall(getChainSettings());
+}
+
+void SimpleEQAudioProcessor::publishRecall(const ChainSettings& chainSettings)
+{
+    auto entry = std::make_unique<Handoff<ChainRecall>::Entry>();
+    auto* recall = &entry->object;
+    recall->settings = chainSettings;
+    recall->sampleRate = getFilterSampleRate();
+
+    // Before prepareToPlay the audio thread designs the chain itself
+    if (getSampleRate() > 0.0) {
+        juce::dsp::ProcessSpec spec;
+        spec.sampleRate = recall->sampleRate;
+        spec.maximumBlockSize = 0;
+        spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
+
+        const int allBands = stageBit(bandPosition(numBands)) - 1;
+
+        if (isUsingDoublePrecision()) {
+            recall->doubleDesign.prepare(spec, NumCascadeSections);
+            updateCascade(recall->doubleDesign, chainSettings, recall->sampleRate, allBands);
+        }
+        else {
+            recall->design.prepare(spec, NumCascadeSections);
+            updateCascade(recall->design, chainSettings, recall->sampleRate, allBands);
+        }
+    }
+
+    recalls.publish(std::move(entry));
+}
+
+void SimpleEQAudioProcessor::publishMorphTable()
+{
+    auto entry = std::make_unique<Handoff<MorphTable>::Entry>();
+    auto& table = entry->object;
+
+    for (int slot = 0; slot < numSnapshots; ++slot)
+        if (hasSnapshot(slot))
+            table.states[static_cast<size_t>(table.numStates++)] = snapshotSettings[static_cast<size_t>(slot)];
+
+    morphTables.publish(std::move(entry));
+}
+
+const ChainSettings& SimpleEQAudioProcessor::getMorphedSettings(int numSamples)
+{
+    const auto& table = morphTable->object;
+    jassert(table.numStates >= 2);
+
+    const auto position = morphSmoother.skip(numSamples) * static_cast<float>(table.numStates - 1);
+    const auto index = juce::jlimit(0, table.numStates - 2, static_cast<int>(position));
+
+    interpolateSettings(morphedSettings, table.states[static_cast<size_t>(index)], table.states[static_cast<size_t>(index + 1)],
+        position - static_cast<float>(index));
+
+    // Like the phase mode, the engine is not part of what morphs
+    morphedSettings.filterEngine = getFilterEngine();
+
+    return morphedSettings;
+}
+
+void SimpleEQAudioProcessor::storeSnapshot()
+{
+    const auto slot = static_cast<size_t>(selectedSnapshot);
+
+    snapshots[slot] = treeState.copyState();
+    snapshotSettings[slot] = getChainSettings();
+    publishMorphTable();
+}
+
+bool SimpleEQAudioProcessor::hasSnapshot(int slot) const
+{
+    return juce::isPositiveAndBelow(slot, numSnapshots) && snapshots[static_cast<size_t>(slot)].isValid();
+}
+
+void SimpleEQAudioProcessor::selectSnapshot(int slot)
+{
+    jassert(juce::isPositiveAndBelow(slot, numSnapshots));
+
+    if (slot == selectedSnapshot)
+        return;
+
+    storeSnapshot();
+
+    const auto previous = static_cast<size_t>(selectedSnapshot);
+    selectedSnapshot = slot;
+
+    if (hasSnapshot(slot)) {
+        recallState(snapshots[static_cast<size_t>(slot)]);
+        return;
+    }
+
+    snapshots[static_cast<size_t>(slot)] = snapshots[previous].createCopy();
+    snapshotSettings[static_cast<size_t>(slot)] = snapshotSettings[previous];
+    publishMorphTable();
+}
+
+template <typename ValueOf>
+ChainSettings SimpleEQAudioProcessor::makeChainSettings(ValueOf&& valueOf) const {
+    ChainSettings settings;
+
+    settings.lowCutFreq = valueOf(lowCutHandles.frequency);
+    settings.lowCutSlope = static_cast<Slope>(valueOf(lowCutHandles.slope));
+    settings.lowCutAlignment = static_cast<CutAlignment>(juce::roundToInt(valueOf(lowCutHandles.alignment)));
+    settings.lowCutBypass = valueOf(lowCutHandles.bypass) < 0.5f;
+
+    settings.highCutFreq = valueOf(highCutHandles.frequency);
+    settings.highCutSlope = static_cast<Slope>(valueOf(highCutHandles.slope));
+    settings.highCutAlignment = static_cast<CutAlignment>(juce::roundToInt(valueOf(highCutHandles.alignment)));
+    settings.highCutBypass = valueOf(highCutHandles.bypass) < 0.5f;
+
+    settings.filterDesign = static_cast<FilterDesign>(juce::roundToInt(valueOf(filterDesignHandle)));
+    settings.filterEngine = getFilterEngine();
+
+    settings.numBands = numBands;
+
+    // The stereo modes fall back to linked on anything but a stereo bus
+    if (getTotalNumOutputChannels() == 2)
+        settings.stereoMode = static_cast<StereoMode>(juce::roundToInt(valueOf(stereoModeHandle)));
+
+    settings.externalSidechain = valueOf(sidechainHandle) >= 0.5f;
+
+    for (size_t i = 0; i < static_cast<size_t>(numBands); ++i) {
+        const auto& handles = bandHandles[i];
+        auto& band = settings.bands[i];
+
+        band.freq = valueOf(handles.frequency);
+        band.gain = valueOf(handles.gain);
+        band.Q = valueOf(handles.quality);
+        band.bypass = valueOf(handles.bypass) < 0.5f;
+        band.type = static_cast<BandType>(juce::roundToInt(valueOf(handles.type)));
+        band.placement = static_cast<BandPlacement>(juce::roundToInt(valueOf(handles.placement)));
+        band.modulation = { valueOf(handles.lfoRate), valueOf(handles.lfoDepth), valueOf(handles.envelopeDepth) };
+        band.dynamics = { valueOf(handles.dynamic) >= 0.5f, valueOf(handles.threshold), valueOf(handles.ratio),
+                          valueOf(handles.attack), valueOf(handles.release) };
     }
 
     return settings;
 }
 
+ChainSettings SimpleEQAudioProcessor::getChainSettings() const {
+    return makeChainSettings([](const std::atomic<float>* handle) { return handle->load(); });
+}
+
+ChainSettings SimpleEQAudioProcessor::getChainSettings(const juce::ValueTree& state) const {
+    // Plain values keyed by the handle that reads them live, defaults first
+    // for anything the state leaves out
+    std::map<const std::atomic<float>*, float> values;
+
+    for (const auto& entry : stateEntries) {
+        auto* parameter = entry.parameter;
+        values[treeState.getRawParameterValue(parameter->paramID)] = parameter->convertFrom0to1(parameter->getDefaultValue());
+    }
+
+    for (const auto& child : state) {
+        if (auto* handle = treeState.getRawParameterValue(child.getProperty("id").toString()))
+            values[handle] = static_cast<float>(child.getProperty("value"));
+    }
+
+    return makeChainSettings([&values](const std::atomic<float>* handle) { return values.at(handle); });
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
@@ -285,144 +1520,135 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
     layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Frequency", "HighCut Frequency", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, freqSkewFactor), 20000.f, "Hz"));
     layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypass", "HighCut Bypass", true));
 
+    const juce::StringArray bandTypes{ "Bell", "Low Shelf", "High Shelf", "Notch", "Tilt", "Band Pass" };
+    const juce::StringArray bandPlacements{ "Both", "Left/Mid", "Right/Side" };
+
     juce::String BandId;
-    for (int i = 1; i <= nBands; ++i) {
+    for (int i = 1; i <= numBands; ++i) {
         BandId = "Band" + std::to_string(i);
-        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Frequency", BandId + " Frequency", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, freqSkewFactor), 1000.f, "Hz"));
+
+        // Defaults spread evenly over the spectrum, in octaves
+        const auto defaultFrequency = std::round(minFreq * std::pow(maxFreq / minFreq, i / (numBands + 1.0f)));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Frequency", BandId + " Frequency", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, freqSkewFactor), defaultFrequency, "Hz"));
         layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Gain", BandId + " Gain", juce::NormalisableRange<float>(-12.f, 12.f, 0.1f, linSkewFactor), 0.f, "dB"));
         layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Quality", BandId + " Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, linSkewFactor), 0.707f));
         layout.add(std::make_unique<juce::AudioParameterBool>(BandId + " Bypass", BandId + " Bypass", true));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(BandId + " Type", BandId + " Type", bandTypes, 0));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(BandId + " Channel", BandId + " Channel", bandPlacements, 0));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " LFO Rate", BandId + " LFO Rate", juce::NormalisableRange<float>(0.05f, 20.f, 0.01f, 0.3f), 1.f, "Hz"));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " LFO Depth", BandId + " LFO Depth", juce::NormalisableRange<float>(0.f, 4.f, 0.01f, linSkewFactor), 0.f, "Oct"));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Env Depth", BandId + " Env Depth", juce::NormalisableRange<float>(-4.f, 4.f, 0.01f, linSkewFactor), 0.f, "Oct"));
+        layout.add(std::make_unique<juce::AudioParameterBool>(BandId + " Dynamic", BandId + " Dynamic", false));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Threshold", BandId + " Threshold", juce::NormalisableRange<float>(-60.f, 0.f, 0.1f, linSkewFactor), -24.f, "dB"));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Ratio", BandId + " Ratio", juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.4f), 2.f, ":1"));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Attack", BandId + " Attack", juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.4f), 5.f, "ms"));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(BandId + " Release", BandId + " Release", juce::NormalisableRange<float>(5.f, 1000.f, 1.f, 0.4f), 120.f, "ms"));
     }
 
     juce::StringArray dbPerOctave;
-    for (int i = 0; i < 4; i++) 
+    for (int i = 0; i < maxCutSections; i++) 
         dbPerOctave.add(std::to_string(12 + i * 12));
 
     
     layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", dbPerOctave, 0, "dB/Oct"));
     layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", dbPerOctave, 0, "dB/Oct"));
 
+    const juce::StringArray alignments{ "Butterworth", "Linkwitz-Riley" };
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Type", "LowCut Type", alignments, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Type", "HighCut Type", alignments, 0));
 
-    return layout;
-}
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Phase Mode", "Phase Mode", juce::StringArray{ "Zero Latency", "Linear Phase" }, 0));
 
-void SimpleEQAudioProcessor::updateBandCoefficients(ChainSettings chainSettings)
-{
-    for (int i = 0; i < nBands; ++i) {
-        // Modify settings to use 0 dB gain when bypassed
-        ChainSettings modifiedSettings = chainSettings;
+    juce::StringArray kernelLengths;
+    for (int i = 0; i < LinearPhaseFilter::numKernelLengths; i++)
+        kernelLengths.add(juce::String(LinearPhaseFilter::minimumKernelLength << i));
 
-        if (i == 0 && chainSettings.band1Bypass) {
-            modifiedSettings.band1Gain = 0.0f;  // Unity gain = transparent
-        }
-        else if (i == 1 && chainSettings.band2Bypass) {
-            modifiedSettings.band2Gain = 0.0f;
-        }
-        else if (i == 2 && chainSettings.band3Bypass) {
-            modifiedSettings.band3Gain = 0.0f;
-        }
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Linear Phase Length", "Linear Phase Length", kernelLengths, 1, "Taps"));
 
-        auto peakCoefficients = makeBandFilter(modifiedSettings, getSampleRate(), i);
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", juce::StringArray{ "Off", "2x", "4x" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Design", "Filter Design", juce::StringArray{ "Bilinear", "Matched" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Engine", "Filter Engine", juce::StringArray{ "Biquad", "State Variable" }, 0));
 
-        if (i == 0)
-        {
-            *leftChain.get<Band1>().coefficients = *peakCoefficients;
-            *rightChain.get<Band1>().coefficients = *peakCoefficients;
-        }
-        if (i == 1) {
-            *leftChain.get<Band2>().coefficients = *peakCoefficients;
-            *rightChain.get<Band2>().coefficients = *peakCoefficients;
-        }
-        if (i == 2) {
-            *leftChain.get<Band3>().coefficients = *peakCoefficients;
-            *rightChain.get<Band3>().coefficients = *peakCoefficients;
-        }
-    }
-}
+    juce::StringArray controlIntervals;
+    for (int i = 0; i < 4; i++)
+        controlIntervals.add(juce::String(minControlInterval << i));
 
-void SimpleEQAudioProcessor::updateFilters()
-{
-    auto chainSettings = getChainSettings(treeState);
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Control Rate", "Control Rate", controlIntervals, 1, "Samples"));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Stereo Mode", "Stereo Mode", juce::StringArray{ "Linked", "Dual Mono", "Mid/Side" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Sidechain", "External Sidechain", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Morph Enabled", "Morph Enabled", false));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Morph", "Morph", juce::NormalisableRange<float>(0.f, 1.f, 0.001f, linSkewFactor), 0.f));
 
-    updateLowFilters(chainSettings);
-    updateBandFilters(chainSettings);
-    updateHighFilters(chainSettings);
+
+    return layout;
 }
 
-void SimpleEQAudioProcessor::updateLowFilters(ChainSettings chainSettings)
+void SimpleEQAudioProcessor::updateFilters(const ChainSettings& chainSettings)
 {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    int dirtyStages = getDirtyStages(chainSettings, appliedSettings);
 
-    auto& leftLowCut = leftChain.get<LowCut>();
-    auto& rightLowCut = rightChain.get<LowCut>();
+    // Designed for the oversampled rate when oversampling is on
+    const double filterSampleRate = getSampleRate() * (1 << oversamplingOrder);
 
-    leftLowCut.setBypassed<0>(chainSettings.lowCutBypass);  
-    leftLowCut.setBypassed<1>(chainSettings.lowCutBypass);  
-    leftLowCut.setBypassed<2>(chainSettings.lowCutBypass);  
-    leftLowCut.setBypassed<3>(chainSettings.lowCutBypass);  
+    if (filterSampleRate != appliedSampleRate) {
+        // Bands past numBands have no parameters and stay switched out
+        dirtyStages = stageBit(bandPosition(numBands)) - 1;
+        appliedSampleRate = filterSampleRate;
+    }
 
-    rightLowCut.setBypassed<0>(chainSettings.lowCutBypass); 
-    rightLowCut.setBypassed<1>(chainSettings.lowCutBypass); 
-    rightLowCut.setBypassed<2>(chainSettings.lowCutBypass); 
-    rightLowCut.setBypassed<3>(chainSettings.lowCutBypass); 
+    if (dirtyStages == 0) {
+        // Modulation rates and depths need no redesign but are read from here
+        appliedSettings = chainSettings;
 
-    updateCutCoefficients(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutCoefficients(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-}
+        if (isPublishPending)
+            publishAppliedSettings();
 
+        return;
+    }
 
+    int filterTailSamples = 0;
 
-void SimpleEQAudioProcessor::updateBandFilters(ChainSettings chainSettings)
-{
-    updateBandCoefficients(chainSettings);
-}
+    if (isUsingDoublePrecision()) {
+        updateCascade(getCascade<double>(), chainSettings, filterSampleRate, dirtyStages);
+        filterTailSamples = getCascade<double>().getTailLengthSamples(silenceThreshold);
+    }
+    else {
+        updateCascade(getCascade<float>(), chainSettings, filterSampleRate, dirtyStages);
+        filterTailSamples = getCascade<float>().getTailLengthSamples(silenceThreshold);
+    }
 
-void SimpleEQAudioProcessor::updateHighFilters(ChainSettings chainSettings)
-{
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    coefficientUpdateCount.fetch_add(static_cast<juce::uint32>(juce::countNumberOfBits(static_cast<juce::uint32>(dirtyStages))));
 
-    auto& leftHighCut = leftChain.get<HighCut>();
-    auto& rightHighCut = rightChain.get<HighCut>();
+    // The tail is counted in host samples
+    tailLengthSamples = filterTailSamples >> oversamplingOrder;
+    tailLengthSeconds.store(tailLengthSamples / getSampleRate());
 
-    leftHighCut.setBypassed<0>(chainSettings.highCutBypass);
-    leftHighCut.setBypassed<1>(chainSettings.highCutBypass);
-    leftHighCut.setBypassed<2>(chainSettings.highCutBypass);
-    leftHighCut.setBypassed<3>(chainSettings.highCutBypass);
+    appliedSettings = chainSettings;
+    settingsVersion.fetch_add(1);
+    publishAppliedSettings();
+}
 
-    rightHighCut.setBypassed<0>(chainSettings.highCutBypass);
-    rightHighCut.setBypassed<1>(chainSettings.highCutBypass);
-    rightHighCut.setBypassed<2>(chainSettings.highCutBypass);
-    rightHighCut.setBypassed<3>(chainSettings.highCutBypass);
+void SimpleEQAudioProcessor::publishAppliedSettings()
+{
+    const juce::SpinLock::ScopedTryLockType lock(publishedSettingsLock);
+    isPublishPending = !lock.isLocked();
 
-    updateCutCoefficients(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutCoefficients(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
-}
+    if (isPublishPending)
+        return;
 
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& leftLowCut, const CoefficientType& coefficients) {
-    *leftLowCut.get<Index>().coefficients = *coefficients[Index];
-    leftLowCut.setBypassed<Index>(false);
+    publishedSettings = appliedSettings;
+    publishedVersion = settingsVersion.load();
 }
 
-template<typename ChainType, typename CoefficientType>
-void SimpleEQAudioProcessor::updateCutCoefficients(ChainType& leftLowCut, const CoefficientType& lowCutCoefficients, const Slope& lowCutSlope)
+juce::uint32 SimpleEQAudioProcessor::getAppliedSettings(ChainSettings& settings) const
 {
+    const juce::SpinLock::ScopedLockType lock(publishedSettingsLock);
 
-    leftLowCut.setBypassed<0>(true);
-    leftLowCut.setBypassed<1>(true);
-    leftLowCut.setBypassed<2>(true);
-    leftLowCut.setBypassed<3>(true);
+    if (publishedVersion != 0)
+        settings = publishedSettings;
 
-    switch (lowCutSlope) {
-    case Slope_48:
-        update<3>(leftLowCut, lowCutCoefficients);
-    case Slope_36:
-        update<2>(leftLowCut, lowCutCoefficients);
-    case Slope_24:
-        update<1>(leftLowCut, lowCutCoefficients);
-    case Slope_12:
-        update<0>(leftLowCut, lowCutCoefficients);
-    }
+    return publishedVersion;
 }
 
 //==============================================================================
@@ -10,58 +10,182 @@
 
 #include <JuceHeader.h>
 #include "FFTAnalyzer.h"
+#include "BiquadCascade.h"
+#include "LinearPhaseFilter.h"
+#include "ModulatedBands.h"
+#include "DynamicBands.h"
+#include "Handoff.h"
 
-using Filter = juce::dsp::IIR::Filter<float>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, Filter, Filter, CutFilter>;
+using Cascade = BiquadCascade<float>;
 
 enum Channel {
     Right,
     Left
 };
 
+// Upper bound on the number of peak/shelf bands; each processor instance
+// picks how many it exposes when it is constructed
+constexpr int maxBands = 24;
+
 enum ChainPositions {
     LowCut,
-    Band1,
-    Band2,
-    Band3,
-    HighCut
+    HighCut,
+    FirstBand           // one position per band from here on
+};
+
+constexpr int bandPosition(int band) { return FirstBand + band; }
+
+// Dirty bits, one per ChainPositions entry
+constexpr int stageBit(int position) { return 1 << position; }
+constexpr int allStages = stageBit(bandPosition(maxBands)) - 1;
+
+// Section layout of the Cascade: a run of sections per cut filter, one per
+// band. Sections of bands an instance does not expose are never switched in.
+constexpr int maxCutSections = 8;     // order 16, 96 dB/oct
+
+enum CascadeSections {
+    LowCutFirstSection = 0,
+    FirstBandSection = LowCutFirstSection + maxCutSections,
+    HighCutFirstSection = FirstBandSection + maxBands,
+    NumCascadeSections = HighCutFirstSection + maxCutSections
 };
 
 enum Slope {
     Slope_12,
     Slope_24,
     Slope_36,
-    Slope_48
+    Slope_48,
+    Slope_60,
+    Slope_72,
+    Slope_84,
+    Slope_96
+};
+
+enum CutAlignment {
+    Alignment_Butterworth,
+    Alignment_LinkwitzRiley
+};
+
+// How the peak bands and the high cut map the analog prototypes to biquads
+enum FilterDesign {
+    Design_Bilinear,
+    Design_Matched
+};
+
+// Biquads in the cascade, or state-variable filters whose coefficients
+// glide sample by sample between control blocks. The state-variable engine
+// matches the bilinear designs and ignores the filter design choice.
+enum FilterEngine {
+    Engine_Biquad,
+    Engine_StateVariable
+};
+
+enum BandType {
+    Band_Bell,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_Notch,
+    Band_Tilt,
+    Band_BandPass
+};
+
+// Linked runs one set of settings on every channel. Dual mono and mid/side
+// apply each band to both channels or to just the first (left or mid) or the
+// second (right or side); they need a stereo bus.
+enum StereoMode {
+    Stereo_Linked,
+    Stereo_DualMono,
+    Stereo_MidSide
+};
+
+enum BandPlacement {
+    Placement_Both,
+    Placement_First,
+    Placement_Second
+};
+
+struct BandSettings {
+    float freq = 1000;
+    float gain = 0;
+    float Q = 0.707;
+    bool bypass = false;
+    BandType type = Band_Bell;
+    BandPlacement placement = Placement_Both;
+    BandModulation modulation;
+    BandDynamics dynamics;
 };
 
 struct ChainSettings {
-    float band1Freq = 0;
-    float band1Gain = 0;
-    float band1Q = 0.707;
-    bool band1Bypass = false;
-    float band2Freq = 0;
-    float band2Gain = 0;
-    float band2Q = 0.707;
-	bool band2Bypass = false;
-    float band3Freq = 0;
-    float band3Gain = 0;
-    float band3Q = 0.707;
-	bool band3Bypass = false;
+    std::array<BandSettings, maxBands> bands;
+    int numBands = 0;
     float lowCutFreq = 0;
     Slope lowCutSlope = Slope_12;
+    CutAlignment lowCutAlignment = Alignment_Butterworth;
 	bool lowCutBypass = false;
     float highCutFreq = 0;
     Slope highCutSlope = Slope_12;
+    CutAlignment highCutAlignment = Alignment_Butterworth;
 	bool highCutBypass = false;
+    FilterDesign filterDesign = Design_Bilinear;
+    FilterEngine filterEngine = Engine_Biquad;
+    StereoMode stereoMode = Stereo_Linked;
+    bool externalSidechain = false;
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-using IIRCoefficients = juce::dsp::IIR::Coefficients<float>;
-
-Coefficients makeBandFilter(const ChainSettings& chainSettings, double sampleRate, int index);
-juce::ReferenceCountedArray<IIRCoefficients> makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate);
-juce::ReferenceCountedArray<IIRCoefficients> makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate);
+// Stages that are transparent are switched out of the cascade instead of
+// running unity-gain biquads: bands within this gain of 0 dB (notch and
+// band-pass bands never are), and cut filters parked at the end of the
+// frequency range
+constexpr float transparentBandGainDb = 0.05f;
+constexpr float parkedLowCutFrequency = 20.0f;
+constexpr float parkedHighCutFrequency = 20000.0f;
+
+// Returns the stageBit()s of every stage whose settings differ between the two snapshots
+int getDirtyStages(const ChainSettings& current, const ChainSettings& previous);
+
+// Blend of two settings for morphing, amount running from 0 (from) to 1
+// (to): frequencies, Q and times in octaves, gains and depths linearly in
+// their units, switches and choices halfway. Allocation-free.
+void interpolateSettings(ChainSettings& result, const ChainSettings& from, const ChainSettings& to, float amount);
+
+// Allocation-free designers writing one section's coefficients into the Cascade
+template <typename SampleType>
+void designBandFilter(SampleType* coefficients, const ChainSettings& chainSettings, double sampleRate, int band);
+template <typename SampleType>
+void designLowCutSection(SampleType* coefficients, const ChainSettings& chainSettings, double sampleRate, int section);
+template <typename SampleType>
+void designHighCutSection(SampleType* coefficients, const ChainSettings& chainSettings, double sampleRate, int section);
+
+// Redesigns and switches in/out the sections of every stage flagged in
+// dirtyStages. Each section is designed once and copied to, or replaced by
+// identity in, the second channel's coefficient set.
+template <typename SampleType>
+void updateCascade(BiquadCascade<SampleType>& cascade, const ChainSettings& chainSettings, double sampleRate, int dirtyStages);
+
+// Bands with modulation, and every band with the state-variable engine,
+// run in ModulatedBands instead of the cascade; so do the cut filters with
+// that engine. Tilt bands have no state-variable form and stay in the
+// cascade, ignoring their modulation.
+bool isBandStateVariable(const ChainSettings& chainSettings, int band);
+
+template <typename SampleType>
+void updateModulatedBands(ModulatedBands<SampleType>& modulatedBands, const ChainSettings& chainSettings);
+
+// Bell bands with dynamics enabled stay in the cascade, their gain driven by
+// DynamicBands; dynamics take precedence over modulation
+bool isBandDynamic(const ChainSettings& chainSettings, int band);
+
+template <typename SampleType>
+void updateDynamicBands(DynamicBands<SampleType>& dynamicBands, const ChainSettings& chainSettings, double sampleRate);
+
+// Rewrites the cascade sections of the dynamic bands at their current gain
+template <typename SampleType>
+void updateDynamicSections(BiquadCascade<SampleType>& cascade, const DynamicBands<SampleType>& dynamicBands, const ChainSettings& chainSettings);
+
+// 32-bit FNV-1a over the UTF-8 bytes of a parameter ID, as stored in the
+// binary state. Unlike juce::String::hashCode it is defined here, so it can
+// never change under a saved session.
+juce::uint32 getParameterIdHash(const juce::String& parameterId);
 
 //==============================================================================
 /**
@@ -76,16 +200,22 @@ public:
     float midFreq = sqrt(minFreq * maxFreq);
     float freqSkewFactor = log(0.5) / log((midFreq - minFreq) / (maxFreq - minFreq)); //source: https://jucestepbystep.wordpress.com/logarithmic-sliders/
     float linSkewFactor = 1.0f;
-    const int nBands = 3;
+    static constexpr int defaultNumBands = 8;
+    static constexpr int maxOversamplingOrder = 2;     // 4x
+    static constexpr int minControlInterval = 16;      // samples
+    static constexpr int numSnapshots = 4;             // A to D
+
+    // Bands exposed as parameters, fixed for the lifetime of the instance
+    const int numBands;
 
     juce::AudioProcessorValueTreeState treeState{ *this, nullptr, "PARAMETERS", createParameterLayout() };
 
-    // FFT analyser FIFO – the audio thread pushes samples here
+    // FFT analyser FIFO – the audio thread pushes samples here while an analyser is attached
     SampleFifo leftChannelFifo;
 
 public:
     //==============================================================================
-    SimpleEQAudioProcessor();
+    explicit SimpleEQAudioProcessor(int numBandsToUse = defaultNumBands);
     ~SimpleEQAudioProcessor() override;
 
     //==============================================================================
@@ -97,6 +227,8 @@ public:
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -121,25 +253,337 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
-    ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& treeState);
+    ChainSettings getChainSettings() const;
+    juce::uint32 getSettingsVersion() const { return settingsVersion.load(); }
+
+    // Copies the settings the audio thread last applied, morphed and
+    // smoothed, and returns their version; 0 until the first ones are
+    // published, with settings left alone. Any thread.
+    juce::uint32 getAppliedSettings(ChainSettings& settings) const;
+
+    // Blocks processed so far, to tell whether the audio thread is running
+    juce::uint32 getProcessedBlockCount() const { return processedBlockCount.load(); }
+
+    // The engine the settings run on. Linear phase always builds its kernel
+    // from biquads.
+    FilterEngine getFilterEngine() const;
+
+    // Rate the cascade is designed for: the host rate times the oversampling
+    // factor selected by the parameters
+    double getFilterSampleRate() const;
 
     //==============================================================================
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    void updateBandCoefficients(ChainSettings chainSettings);
-    template<typename ChainType, typename CoefficientType>
-    void updateCutCoefficients(ChainType& leftLowCut, const CoefficientType& cutCoefficients, const Slope& lowCutSlope);
-    void updateFilters();
-    void updateLowFilters(ChainSettings chainSettings);
-    void updateBandFilters(ChainSettings chainSettings);
-    void updateHighFilters(ChainSettings chainSettings);
+    // Redesigns the stages whose settings differ from the ones last applied
+    void updateFilters(const ChainSettings& chainSettings);
 
-private:
-    MonoChain leftChain, rightChain;
+    // Sub-block length at which smoothed parameters are applied
+    int getControlInterval() const;
+
+    // Stages redesigned since the plugin was created, to gauge the cost of
+    // the control rate
+    juce::uint32 getCoefficientUpdateCount() const { return coefficientUpdateCount.load(); }
 
+    // A/B/C/D snapshots of every parameter. The selected slot follows the
+    // edits: selecting another one stores them in the current slot, then
+    // recalls the new slot, or copies them into it if it is still empty.
+    // Message thread only.
+    void selectSnapshot(int slot);
+    int getSelectedSnapshot() const { return selectedSnapshot; }
+    bool hasSnapshot(int slot) const;
 
+    // Stores the current parameters in the selected slot. With "Morph
+    // Enabled" on, the EQ follows a blend of the stored slots, in slot order,
+    // at the "Morph" position instead of the parameters.
+    void storeSnapshot();
 
+private:
+    // Only the cascades matching the host's processing precision are
+    // prepared and kept designed; a precision change always comes with
+    // prepareToPlay. A recall crossfades from the live cascade into the other
+    // one, which stays live afterwards.
+    std::array<Cascade, 2> cascades;
+    std::array<BiquadCascade<double>, 2> doubleCascades;
+    int liveCascade = 0;
+
+    template <typename SampleType>
+    std::array<BiquadCascade<SampleType>, 2>& getCascades()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleCascades;
+        else
+            return cascades;
+    }
+
+    template <typename SampleType>
+    BiquadCascade<SampleType>& getCascade() { return getCascades<SampleType>()[static_cast<size_t>(liveCascade)]; }
+
+    // Runs the live cascade, mixed over the outgoing one while a recall's
+    // crossfade lasts. The outgoing cascade filters a copy of the input.
+    template <typename SampleType>
+    void processCascade(juce::dsp::AudioBlock<SampleType>& block);
+
+    static constexpr double crossfadeSeconds = 0.02;
+    int crossfadeLength = 0;
+    int crossfadeRemaining = 0;
+
+    juce::AudioBuffer<float> crossfadeBuffer;
+    juce::AudioBuffer<double> doubleCrossfadeBuffer;
+
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType>& getCrossfadeBuffer()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleCrossfadeBuffer;
+        else
+            return crossfadeBuffer;
+    }
+
+    // A complete chain designed off the audio thread, for recalls. The audio
+    // thread releases it once the design is copied.
+    struct ChainRecall
+    {
+        ChainSettings settings;
+        double sampleRate = 0.0;
+        Cascade design;
+        BiquadCascade<double> doubleDesign;
+    };
+
+    Handoff<ChainRecall> recalls;
+
+    // Any thread but the audio one
+    void publishRecall(const ChainSettings& chainSettings);
+    void recallState(const juce::ValueTree& state);
+
+    template <typename SampleType>
+    void applyRecall(const ChainRecall& recall);
+
+    std::array<juce::ValueTree, numSnapshots> snapshots;
+    std::array<ChainSettings, numSnapshots> snapshotSettings;
+    int selectedSnapshot = 0;
+
+    // Settings a stored state would give, read without touching the
+    // parameters. Message thread only.
+    ChainSettings getChainSettings(const juce::ValueTree& state) const;
+
+    // Builds the settings from what valueOf returns for each parameter handle
+    template <typename ValueOf>
+    ChainSettings makeChainSettings(ValueOf&& valueOf) const;
+
+    // The snapshots are saved with the parameters: after the entries in the
+    // binary state, as a child tree in the ValueTree one. A state without
+    // them leaves every slot empty.
+    void setSnapshot(int slot, const juce::ValueTree& state);
+    void clearSnapshots();
+    void writeBinarySnapshots(juce::OutputStream& stream) const;
+    void readBinarySnapshots(juce::InputStream& stream);
+    juce::ValueTree createSnapshotsTree() const;
+    void restoreSnapshots(const juce::ValueTree& snapshotsTree);
+
+    // The stored snapshots in slot order, for morphing. The audio thread
+    // keeps the current table until a new one is published, then releases it.
+    struct MorphTable
+    {
+        std::array<ChainSettings, numSnapshots> states;
+        int numStates = 0;
+    };
+
+    Handoff<MorphTable> morphTables;
+    Handoff<MorphTable>::Entry* morphTable = nullptr;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> morphSmoother;
+    ChainSettings morphedSettings;
+
+    void publishMorphTable();
+
+    // Blends the table's states at the smoothed morph position, advanced by
+    // numSamples. Only valid with at least two states.
+    const ChainSettings& getMorphedSettings(int numSamples);
+
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+
+    // Stages on the state-variable engine, filtered after the cascade
+    ModulatedBands<float> modulatedBands;
+    ModulatedBands<double> doubleModulatedBands;
+
+    template <typename SampleType>
+    ModulatedBands<SampleType>& getModulatedBands()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleModulatedBands;
+        else
+            return modulatedBands;
+    }
+
+    // Detectors of the dynamic bands, run on each control block before the
+    // cascade filters it. The linear-phase kernel uses their static gain.
+    DynamicBands<float> dynamicBands;
+    DynamicBands<double> doubleDynamicBands;
+
+    template <typename SampleType>
+    DynamicBands<SampleType>& getDynamicBands()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleDynamicBands;
+        else
+            return dynamicBands;
+    }
+
+    // Oversampling around the cascade, one oversampler per factor so the
+    // factor can change without reallocating. The linear-phase path always
+    // runs at the host rate.
+    template <typename SampleType>
+    using Oversamplers = std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, maxOversamplingOrder>;
+
+    Oversamplers<float> oversamplers;
+    Oversamplers<double> doubleOversamplers;
+    int oversamplingOrder = 0;
+
+    template <typename SampleType>
+    Oversamplers<SampleType>& getOversamplers()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleOversamplers;
+        else
+            return oversamplers;
+    }
+
+    template <typename SampleType>
+    void prepareOversamplers(int numChannels, int samplesPerBlock);
+
+    int getOversamplingOrder() const;
+    int getCurrentLatencySamples();
+
+    // Raw parameter handles, resolved once in the constructor so that reading
+    // the settings on the audio thread never does string-keyed lookups
+    struct CutParameterHandles
+    {
+        std::atomic<float>* frequency = nullptr;
+        std::atomic<float>* slope = nullptr;
+        std::atomic<float>* alignment = nullptr;
+        std::atomic<float>* bypass = nullptr;
+    };
+
+    struct BandParameterHandles
+    {
+        std::atomic<float>* frequency = nullptr;
+        std::atomic<float>* gain = nullptr;
+        std::atomic<float>* quality = nullptr;
+        std::atomic<float>* bypass = nullptr;
+        std::atomic<float>* type = nullptr;
+        std::atomic<float>* placement = nullptr;
+        std::atomic<float>* lfoRate = nullptr;
+        std::atomic<float>* lfoDepth = nullptr;
+        std::atomic<float>* envelopeDepth = nullptr;
+        std::atomic<float>* dynamic = nullptr;
+        std::atomic<float>* threshold = nullptr;
+        std::atomic<float>* ratio = nullptr;
+        std::atomic<float>* attack = nullptr;
+        std::atomic<float>* release = nullptr;
+    };
+
+    CutParameterHandles lowCutHandles, highCutHandles;
+    std::array<BandParameterHandles, maxBands> bandHandles;
+    std::atomic<float>* phaseModeHandle = nullptr;
+    std::atomic<float>* kernelLengthHandle = nullptr;
+    std::atomic<float>* oversamplingHandle = nullptr;
+    std::atomic<float>* filterDesignHandle = nullptr;
+    std::atomic<float>* filterEngineHandle = nullptr;
+    std::atomic<float>* controlRateHandle = nullptr;
+    std::atomic<float>* stereoModeHandle = nullptr;
+    std::atomic<float>* sidechainHandle = nullptr;
+    std::atomic<float>* morphHandle = nullptr;
+    std::atomic<float>* morphEnabledHandle = nullptr;
+
+    // Continuous parameters glide to their targets and are applied once per
+    // control interval, so automation moves the coefficients in small steps
+    // instead of one jump per host block
+    static constexpr double smoothingSeconds = 0.02;
+
+    using FrequencySmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    using GainSmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+    struct BandSmoothers
+    {
+        FrequencySmoother frequency;
+        GainSmoother gain;
+        FrequencySmoother quality;
+    };
+
+    FrequencySmoother lowCutSmoother, highCutSmoother;
+    std::array<BandSmoothers, maxBands> bandSmoothers;
+    std::atomic<juce::uint32> coefficientUpdateCount{ 0 };
+
+    void resetSmoothers(const ChainSettings& chainSettings, double sampleRate);
+    ChainSettings getSmoothedSettings(const ChainSettings& targetSettings, int numSamples);
+
+    // Settings the cascade was last designed for. Only the stages whose
+    // inputs differ from this snapshot get their coefficients recomputed.
+    ChainSettings appliedSettings;
+    double appliedSampleRate = 0.0;
+    std::atomic<juce::uint32> settingsVersion{ 0 };
+
+    // Copy of appliedSettings for other threads. The audio thread only
+    // tries the lock; if a reader holds it, the copy is retried on the next
+    // control block.
+    mutable juce::SpinLock publishedSettingsLock;
+    ChainSettings publishedSettings;
+    juce::uint32 publishedVersion = 0;
+    bool isPublishPending = false;
+    std::atomic<juce::uint32> processedBlockCount{ 0 };
+
+    void publishAppliedSettings();
+
+    // Linear-phase mode replaces the cascade with an FIR kernel designed from
+    // the same settings, at the cost of half the kernel length in latency.
+    // Its designer thread reads the parameter handles and the published
+    // settings above, so it is declared after them and destroyed first.
+    LinearPhaseFilter linearPhase{ *this };
+    bool bLinearPhase = false;
+
+    int getLinearPhaseKernelLength() const;
+
+    // Idle mode: once the input has been silent for longer than the filter
+    // tail and the state has decayed, blocks are zeroed instead of filtered
+    static constexpr float silenceThreshold = 1.0e-6f;     // -120 dB
+    int tailLengthSamples = 0;
+    int silentSamples = 0;
+    bool isIdle = false;
+    std::atomic<double> tailLengthSeconds{ 0.0 };
+
+    template <typename SampleType>
+    bool isInputSilent(const juce::AudioBuffer<SampleType>& buffer) const;
+
+    void cacheParameterHandles();
+
+    // Binary state, little-endian: magic, version and entry count, then the
+    // hash of each parameter's ID and its plain value. An optional snapshot
+    // section may follow: its tag, the selected slot, then per slot an entry
+    // count (-1 when empty) and that many entries. Parameters are found
+    // by hash (getParameterIdHash), so states from instances with other band
+    // counts load too. States saved before the binary format hold the
+    // ValueTree and are still read; it is also what gets written should two
+    // IDs ever share a hash.
+    static constexpr int stateMagic = 0x42514553;      // "SEQB"
+    static constexpr int stateVersion = 1;
+    static constexpr int stateHeaderSize = 3 * 4;
+    static constexpr int stateEntrySize = 2 * 4;
+    static constexpr int stateSnapshotTag = 0x50414e53; // "SNAP"
+
+    struct StateEntry
+    {
+        juce::uint32 idHash = 0;
+        juce::RangedAudioParameter* parameter = nullptr;
+    };
+
+    std::vector<StateEntry> stateEntries;       // sorted by idHash
+    std::vector<char> stateEntryLoaded;
+    bool hasStateHashCollision = false;
+
+    void cacheStateEntries();
+    bool loadBinaryState(const void* data, int sizeInBytes);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimpleEQAudioProcessor)
@@ -1,5 +1,22 @@
 #include "ResponseCurveComponent.h"
+#include "Theme.h"
 
+namespace
+{
+    struct AnalyzerResolution
+    {
+        const char* name;
+        AnalyzerSettings settings;
+    };
+
+    const AnalyzerResolution analyzerResolutions[] = {
+        { "1K",    { 10, defaultAnalyzerHopSize, false } },
+        { "2K",    { 11, defaultAnalyzerHopSize, false } },
+        { "4K",    { 12, defaultAnalyzerHopSize, false } },
+        { "8K",    { 13, defaultAnalyzerHopSize, false } },
+        { "MULTI", { 11, defaultAnalyzerHopSize, true } }
+    };
+}
 
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) :
     audioProcessor(p)
@@ -24,12 +41,43 @@ ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) :
     fftToggleButton.onClick = [this]()
         {
             bShowFFT = fftToggleButton.getToggleState();
+            repaint();
         };
     addAndMakeVisible(fftToggleButton);
 
+    // Lit while high sample rates are decimated before the analyser
+    fftDecimateButton.setClickingTogglesState(true);
+    fftDecimateButton.setToggleState(true, juce::dontSendNotification);
+
+    fftDecimateButton.setColour(juce::TextButton::buttonOnColourId, juce::Colour(70, 150, 255).withAlpha(0.15f));
+    fftDecimateButton.setColour(juce::TextButton::buttonColourId, juce::Colour(25, 27, 32));
+    fftDecimateButton.setColour(juce::TextButton::textColourOnId, juce::Colour(70, 150, 255));
+    fftDecimateButton.setColour(juce::TextButton::textColourOffId, juce::Colour(80, 85, 95));
+    fftDecimateButton.setColour(juce::ComboBox::outlineColourId, juce::Colour(50, 55, 65));
+
+    fftDecimateButton.onClick = [this]()
+        {
+            updateAnalyzerResolution();
+        };
+    addAndMakeVisible(fftDecimateButton);
+
+    fftResolutionButton.setColour(juce::TextButton::buttonColourId, juce::Colour(25, 27, 32));
+    fftResolutionButton.setColour(juce::TextButton::textColourOffId, juce::Colour(70, 150, 255));
+    fftResolutionButton.setColour(juce::ComboBox::outlineColourId, juce::Colour(50, 55, 65));
+
+    fftResolutionButton.onClick = [this]()
+        {
+            fftResolutionIndex = (fftResolutionIndex + 1) % static_cast<int>(std::size(analyzerResolutions));
+            updateAnalyzerResolution();
+        };
+    addAndMakeVisible(fftResolutionButton);
+    updateAnalyzerResolution();
+
     startTimerHz(60);
 
-    updateChain();
+    // Only used for its magnitude response, so it needs no channel state
+    monoCascade.prepare({ audioProcessor.getSampleRate(), 0, 0 }, NumCascadeSections);
+    updateChain(true);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
@@ -50,55 +98,62 @@ void ResponseCurveComponent::timerCallback()
     bool needsRepaint = false;
 
     if (parametersChanged.compareAndSetBool(false, true)) {
-        updateChain();
-        needsRepaint = true;
+        framesUntilParameterFallback = parameterFallbackFrames;
+        blockCountAtChange = audioProcessor.getProcessedBlockCount();
     }
 
-    if (bShowFFT)
-    {
-        auto bounds = getAnalysisArea().toFloat();
-        leftPathProducer.process(bounds, audioProcessor.getSampleRate());
+    if (audioProcessor.getSettingsVersion() != drawnVersion) {
+        updateChain(false);
+        framesUntilParameterFallback = 0;
         needsRepaint = true;
     }
-    else
-    {
-        if (leftPathProducer.getPath().isEmpty() == false)
-        {
-            leftPathProducer.drain();
-            needsRepaint = true;
-        }
+    else if (framesUntilParameterFallback > 0 && --framesUntilParameterFallback == 0
+             && audioProcessor.getProcessedBlockCount() == blockCountAtChange) {
+        updateChain(true);
+        needsRepaint = true;
     }
 
+    // The shared analyser thread does the FFT work; only finished paths get here
+    leftPathProducer.setTarget(getAnalysisArea().toFloat(), audioProcessor.getSampleRate(), bShowFFT);
+
+    if (bShowFFT && leftPathProducer.fetchLatestPath())
+        needsRepaint = true;
+
     if (needsRepaint)
         repaint();
 }
 
-void ResponseCurveComponent::updateChain() {
-    double sampleRate = audioProcessor.getSampleRate();
-    auto chainSettings = audioProcessor.getChainSettings(audioProcessor.treeState);
+void ResponseCurveComponent::updateAnalyzerResolution()
+{
+    const auto& resolution = analyzerResolutions[fftResolutionIndex];
 
-    for (int i = 0; i < audioProcessor.nBands; i++) {
-        auto peakCoefficients = makeBandFilter(chainSettings, audioProcessor.getSampleRate(), i);
-        if (i == 0) {
-            auto& bandFilterCoefficients = monoChain.get<Band1>().coefficients;
-            bandFilterCoefficients = peakCoefficients;
-        }
-        if (i == 1) {
-            auto& bandFilterCoefficients = monoChain.get<Band2>().coefficients;
-            bandFilterCoefficients = peakCoefficients;
-        }
-        if (i == 2) {
-            auto& bandFilterCoefficients = monoChain.get<Band3>().coefficients;
-            bandFilterCoefficients = peakCoefficients;
-        }
+    auto settings = resolution.settings;
+    settings.decimate = fftDecimateButton.getToggleState();
 
-    }
+    fftResolutionButton.setButtonText(resolution.name);
+    leftPathProducer.setSettings(settings);
+}
+
+void ResponseCurveComponent::updateChain(bool useParameters) {
+    ChainSettings chainSettings;
+    drawnVersion = audioProcessor.getAppliedSettings(chainSettings);
+
+    if (useParameters || drawnVersion == 0)
+        chainSettings = audioProcessor.getChainSettings();
+
+    // Modulated bands run outside the cascade; draw them at their resting shape
+    for (auto& band : chainSettings.bands)
+        band.modulation = {};
+
+    // Every stage is drawn through the cascade. The state-variable engine
+    // matches the bilinear designs.
+    if (chainSettings.filterEngine == Engine_StateVariable)
+        chainSettings.filterDesign = Design_Bilinear;
 
-    auto newLowCutCoefficients = makeLowCutFilter(chainSettings, sampleRate);
-    audioProcessor.updateCutCoefficients(monoChain.get<LowCut>(), newLowCutCoefficients, chainSettings.lowCutSlope);
+    chainSettings.filterEngine = Engine_Biquad;
 
-    auto newHighCutCoefficients = makeHighCutFilter(chainSettings, sampleRate);
-    audioProcessor.updateCutCoefficients(monoChain.get<HighCut>(), newHighCutCoefficients, chainSettings.highCutSlope);
+    filterSampleRate = audioProcessor.getFilterSampleRate();
+    updateCascade(monoCascade, chainSettings, filterSampleRate, allStages);
 }
 
 
@@ -118,7 +173,7 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     // Draw FFT spectrum with modern gradient
     if (bShowFFT)
     {
-        auto fftPath = leftPathProducer.getPath();
+        const auto& fftPath = leftPathProducer.getPath();
 
         // Subtle gradient fill under FFT
         ColourGradient fftGradient(
@@ -136,36 +191,24 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         g.strokePath(fftPath, PathStrokeType(1.8f));
     }
 
-    auto& lowcut = monoChain.get<LowCut>();
-    auto& band1 = monoChain.get<Band1>();
-    auto& band2 = monoChain.get<Band2>();
-    auto& band3 = monoChain.get<Band3>();
-    auto& highcut = monoChain.get<HighCut>();
+    auto chainSettings = audioProcessor.getChainSettings();
 
-    auto sampleRate = audioProcessor.getSampleRate();
-    auto chainSettings = audioProcessor.getChainSettings(audioProcessor.treeState);
+    // Dual mono and mid/side draw the second channel's response as well
+    const bool showSecondChannel = monoCascade.getChannelMode() != Cascade::ChannelMode::Shared;
 
     std::vector<double> mags(width);
+    std::vector<double> secondMags(showSecondChannel ? width : 0);
 
     for (int i = 0; i < width; i++) {
-        double mag = 1.f;
         auto freq = mapToLog10(double(i) / double(width), 20.0, 20000.0);
 
-        // Check bypass state for bands
-        if (!chainSettings.band1Bypass)
-            mag *= band1.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!chainSettings.band2Bypass)
-            mag *= band2.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!chainSettings.band3Bypass)
-            mag *= band3.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        // Check bypass state for cut filters
-        if (!chainSettings.lowCutBypass)
-            getMagForFreq(mag, lowcut, 4, freq);
-        if (!chainSettings.highCutBypass)
-            getMagForFreq(mag, highcut, 4, freq);
+        // Bypassed and transparent stages are switched out of the cascade
+        double mag = monoCascade.getMagnitudeForFrequency(freq, filterSampleRate);
 
         mags[i] = Decibels::gainToDecibels(mag);
+
+        if (showSecondChannel)
+            secondMags[i] = Decibels::gainToDecibels(monoCascade.getMagnitudeForFrequency(freq, filterSampleRate, 1));
     }
 
     Path responseCurve;
@@ -208,20 +251,37 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     g.setColour(Colour(150, 240, 255));
     g.strokePath(responseCurve, PathStrokeType(2.2f)); // Main line
 
+    if (showSecondChannel) {
+        Path secondCurve;
+        secondCurve.startNewSubPath(responseArea.getX(), map(secondMags.front()));
+
+        for (size_t i = 0; i < secondMags.size(); i++)
+            secondCurve.lineTo(responseArea.getX() + i, map(secondMags[i]));
+
+        g.setColour(Colour(255, 190, 120));
+        g.strokePath(secondCurve, PathStrokeType(1.6f));
+    }
+
     // --- Filter frequency indicators on the response curve ---
     struct FilterIndicator {
         float freq;
         Colour colour;
         bool bypassed;
+        bool onSecondChannel;
     };
 
-    FilterIndicator indicators[] = {
-        { chainSettings.lowCutFreq,  Colour(255, 80, 80),   chainSettings.lowCutBypass },
-        { chainSettings.band1Freq,   Colour(255, 160, 70),  chainSettings.band1Bypass },
-        { chainSettings.band2Freq,   Colour(100, 220, 120), chainSettings.band2Bypass },
-        { chainSettings.band3Freq,   Colour(80, 180, 255),  chainSettings.band3Bypass },
-        { chainSettings.highCutFreq, Colour(180, 100, 255), chainSettings.highCutBypass },
-    };
+    std::vector<FilterIndicator> indicators;
+    indicators.reserve(static_cast<size_t>(chainSettings.numBands + 2));
+
+    indicators.push_back({ chainSettings.lowCutFreq, Theme::LowCutAccent, chainSettings.lowCutBypass, false });
+
+    for (int i = 0; i < chainSettings.numBands; ++i) {
+        const auto& band = chainSettings.bands[static_cast<size_t>(i)];
+        indicators.push_back({ band.freq, Theme::getBandAccent(i), band.bypass,
+                               showSecondChannel && band.placement == Placement_Second });
+    }
+
+    indicators.push_back({ chainSettings.highCutFreq, Theme::HighCutAccent, chainSettings.highCutBypass, false });
 
     for (auto& ind : indicators)
     {
@@ -234,7 +294,8 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         pixelIndex = jlimit(0, (int)mags.size() - 1, pixelIndex);
 
         float x = static_cast<float>(responseArea.getX() + pixelIndex);
-        float y = static_cast<float>(map(mags[pixelIndex]));
+        const auto& curve = ind.onSecondChannel ? secondMags : mags;
+        float y = static_cast<float>(map(curve[pixelIndex]));
 
         constexpr float outerRadius = 6.0f;
         constexpr float innerRadius = 4.0f;
@@ -367,8 +428,10 @@ void ResponseCurveComponent::resized()
     }
 
     // Modern FFT button placement
-    auto buttonArea = analysisArea.removeFromTop(18).removeFromRight(40).reduced(1);
-    fftToggleButton.setBounds(buttonArea);
+    auto buttonArea = analysisArea.removeFromTop(18);
+    fftToggleButton.setBounds(buttonArea.removeFromRight(40).reduced(1));
+    fftResolutionButton.setBounds(buttonArea.removeFromRight(48).reduced(1));
+    fftDecimateButton.setBounds(buttonArea.removeFromRight(40).reduced(1));
 }
 
 juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
@@ -18,7 +18,17 @@ public:
 protected:
     SimpleEQAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged{ false };
-    MonoChain monoChain;
+    Cascade monoCascade;
+    double filterSampleRate = 0.0;      // rate monoCascade was designed for
+
+    // The curve shows the settings the audio thread applied, morph and
+    // smoothing included. When it stops processing they never move, so
+    // parameter changes it has not picked up within a few frames are drawn
+    // from the parameters.
+    static constexpr int parameterFallbackFrames = 6;
+    juce::uint32 drawnVersion = 0;
+    juce::uint32 blockCountAtChange = 0;
+    int framesUntilParameterFallback = 0;
 
     juce::Image background;
 
@@ -29,28 +39,14 @@ protected:
     juce::TextButton fftToggleButton{ "FFT" };
     bool bShowFFT = true;
 
-    void updateChain();
-    void timerCallback() override;
-
-    template<int Index, typename Filter>
-    inline void getMagForFreqSingle(double& mag, Filter& filter, const double freq);
-    template<typename Filter>
-    inline void getMagForFreq(double& mag, Filter& filter, const int nFilters, const double freq);
-};
+    // Cycles through the analyser resolutions on click
+    juce::TextButton fftResolutionButton;
+    int fftResolutionIndex = 1;
 
+    juce::TextButton fftDecimateButton{ "DEC" };
 
-template<int Index, typename Filter>
-inline void ResponseCurveComponent::getMagForFreqSingle(double& mag, Filter& filter, const double freq)
-{
-    if (!filter.isBypassed<Index>())
-        mag *= filter.get<Index>().coefficients->getMagnitudeForFrequency(freq, audioProcessor.getSampleRate());
-}
+    void updateAnalyzerResolution();
 
-template<typename Filter>
-inline void ResponseCurveComponent::getMagForFreq(double& mag, Filter& filter, const int nFilters, const double freq)
-{
-    getMagForFreqSingle<0>(mag, filter, freq);
-    getMagForFreqSingle<1>(mag, filter, freq);
-    getMagForFreqSingle<2>(mag, filter, freq);
-    getMagForFreqSingle<3>(mag, filter, freq);
-}
\ No newline at end of file
+    void updateChain(bool useParameters);
+    void timerCallback() override;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "StateVariableFilter.h"
+
+namespace StateVariableFilter
+{
+    template <typename SampleType>
+    Coefficients<SampleType> makeCoefficients(Type type, SampleType normalisedFrequency, SampleType Q, SampleType gainDb)
+    {
+        using FastMath = juce::dsp::FastMathApproximations;
+
+        jassert(Q > 0);
+
+        const auto frequency = juce::jlimit(SampleType(1.0e-5), SampleType(0.49), normalisedFrequency);
+        auto g = FastMath::tan(juce::MathConstants<SampleType>::pi * frequency);
+
+        // A = 10^(gainDb / 40)
+        const auto A = FastMath::exp(gainDb * SampleType(0.05756462732485114));
+
+        auto k = 1 / Q;
+        Coefficients<SampleType> coefficients;
+
+        switch (type)
+        {
+            case Type::Bell:
+                // Bandwidth scaled so the response matches the RBJ peak's
+                k = 1 / (Q * A);
+                coefficients.m1 = k * (A * A - 1);
+                break;
+
+            case Type::LowPass:
+                coefficients.m0 = 0;
+                coefficients.m2 = 1;
+                break;
+
+            case Type::HighPass:
+                coefficients.m1 = -k;
+                coefficients.m2 = -1;
+                break;
+
+            case Type::LowShelf:
+                g /= std::sqrt(A);
+                coefficients.m1 = k * (A - 1);
+                coefficients.m2 = A * A - 1;
+                break;
+
+            case Type::HighShelf:
+                g *= std::sqrt(A);
+                coefficients.m0 = A * A;
+                coefficients.m1 = k * (1 - A) * A;
+                coefficients.m2 = 1 - A * A;
+                break;
+
+            case Type::Notch:
+                coefficients.m1 = -k;
+                break;
+
+            case Type::BandPass:
+                coefficients.m0 = 0;
+                coefficients.m1 = k * A * A;
+                break;
+        }
+
+        coefficients.a1 = 1 / (1 + g * (g + k));
+        coefficients.a2 = g * coefficients.a1;
+        coefficients.a3 = g * coefficients.a2;
+
+        return coefficients;
+    }
+
+    template Coefficients<float> makeCoefficients<float>(Type, float, float, float);
+    template Coefficients<double> makeCoefficients<double>(Type, double, double, double);
+}
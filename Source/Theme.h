@@ -11,11 +11,25 @@ namespace Theme
     // Accent colours
 	inline const auto GenericAccent = juce::Colour(100, 180, 255);
     inline const auto LowCutAccent = juce::Colour(255, 80, 80);
-    inline const auto Band1Accent = juce::Colour(255, 160, 70);
-    inline const auto Band2Accent = juce::Colour(100, 220, 120);
-    inline const auto Band3Accent = juce::Colour(80, 180, 255);
     inline const auto HighCutAccent = juce::Colour(180, 100, 255);
 
+    // Bands cycle through these
+    inline const juce::Colour BandAccents[] = {
+        juce::Colour(255, 160, 70),
+        juce::Colour(100, 220, 120),
+        juce::Colour(80, 180, 255),
+        juce::Colour(255, 210, 80),
+        juce::Colour(70, 220, 200),
+        juce::Colour(255, 110, 180),
+        juce::Colour(170, 220, 80),
+        juce::Colour(140, 140, 255)
+    };
+
+    inline juce::Colour getBandAccent(int band)
+    {
+        return BandAccents[static_cast<size_t>(band) % std::size(BandAccents)];
+    }
+
     // Text
     inline const auto TitleText = juce::Colour(220, 225, 235);
     inline const auto SubtleText = juce::Colour(120, 130, 145);
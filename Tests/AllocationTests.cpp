@@ -0,0 +1,202 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    // Set only on the thread under test, so the linear-phase designer and
+    // the analyser keep allocating without being counted
+    thread_local bool isCountingAllocations = false;
+    std::atomic<int> numAllocations{ 0 };
+
+    inline void countAllocation() noexcept
+    {
+        if (isCountingAllocations)
+            numAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#if defined(__GLIBC__)
+// glibc lets a program replace the malloc family; operator new, HeapBlock
+// and AudioBuffer all allocate through it
+extern "C"
+{
+    void* __libc_malloc(std::size_t);
+    void* __libc_calloc(std::size_t, std::size_t);
+    void* __libc_realloc(void*, std::size_t);
+
+    void* malloc(std::size_t size) noexcept { countAllocation(); return __libc_malloc(size); }
+    void* calloc(std::size_t count, std::size_t size) noexcept { countAllocation(); return __libc_calloc(count, size); }
+    void* realloc(void* pointer, std::size_t size) noexcept { countAllocation(); return __libc_realloc(pointer, size); }
+}
+#else
+// Elsewhere only operator new is hooked
+void* operator new(std::size_t size)
+{
+    countAllocation();
+
+    if (auto* pointer = std::malloc(size > 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+//==============================================================================
+// processBlock must not allocate once prepared: neither with the settings
+// held still, nor while parameters, band types, stereo modes, oversampling
+// and morphing change between blocks. Only processBlock itself is counted;
+// the parameter changes come from the host side and may allocate.
+class ProcessBlockAllocationTest : public juce::UnitTest
+{
+public:
+    ProcessBlockAllocationTest() : juce::UnitTest("processBlock allocations", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        runWithPrecision<float>(juce::AudioProcessor::singlePrecision, "float");
+        runWithPrecision<double>(juce::AudioProcessor::doublePrecision, "double");
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int maximumBlockSize = 512;
+    static constexpr int numWarmUpBlocks = 16;
+    static constexpr int numBlocks = 500;
+    static constexpr int numChangesPerBlock = 4;
+
+    static void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterId, float value)
+    {
+        auto* parameter = processor.treeState.getParameter(parameterId);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Cuts engaged and every band away from 0 dB, so nothing is switched out
+    static void setUpEq(SimpleEQAudioProcessor& processor)
+    {
+        setParameter(processor, "LowCut Frequency", 80.0f);
+        setParameter(processor, "LowCut Slope", 3.0f);
+        setParameter(processor, "HighCut Frequency", 12000.0f);
+        setParameter(processor, "HighCut Slope", 2.0f);
+
+        for (int band = 1; band <= processor.numBands; ++band)
+            setParameter(processor, "Band" + juce::String(band) + " Gain", band % 2 == 0 ? 6.0f : -6.0f);
+    }
+
+    // Two snapshots for the morph to move between, morphing off to start with
+    static void setUpSnapshots(SimpleEQAudioProcessor& processor)
+    {
+        processor.storeSnapshot();
+        processor.selectSnapshot(1);
+
+        for (int band = 1; band <= processor.numBands; ++band)
+            setParameter(processor, "Band" + juce::String(band) + " Frequency", 200.0f * static_cast<float>(band));
+
+        processor.storeSnapshot();
+    }
+
+    static juce::Array<juce::RangedAudioParameter*> getAutomatedParameters(SimpleEQAudioProcessor& processor)
+    {
+        juce::StringArray ids{ "LowCut Frequency", "LowCut Slope", "LowCut Type", "HighCut Frequency", "HighCut Slope",
+                               "HighCut Type", "Filter Design", "Filter Engine", "Control Rate", "Stereo Mode", "Oversampling",
+                               "Morph Enabled", "Morph" };
+
+        for (int band = 1; band <= processor.numBands; ++band)
+            for (auto* suffix : { " Frequency", " Gain", " Quality", " Bypass", " Type", " Channel",
+                                  " LFO Depth", " Env Depth", " Dynamic", " Threshold" })
+                ids.add("Band" + juce::String(band) + suffix);
+
+        juce::Array<juce::RangedAudioParameter*> parameters;
+
+        for (const auto& id : ids)
+            parameters.add(processor.treeState.getParameter(id));
+
+        return parameters;
+    }
+
+    template <typename SampleType>
+    int countAllocations(SimpleEQAudioProcessor& processor, int numBlocksToProcess, juce::Random& random,
+                         const juce::Array<juce::RangedAudioParameter*>& automatedParameters)
+    {
+        const int numChannels = processor.getTotalNumInputChannels();
+        juce::AudioBuffer<SampleType> buffer(numChannels, maximumBlockSize);
+        juce::MidiBuffer midi;
+        int total = 0;
+
+        for (int block = 0; block < numBlocksToProcess; ++block)
+        {
+            for (int i = 0; i < numChangesPerBlock && !automatedParameters.isEmpty(); ++i)
+                automatedParameters[random.nextInt(automatedParameters.size())]->setValueNotifyingHost(random.nextFloat());
+
+            const int numSamples = automatedParameters.isEmpty() ? maximumBlockSize : 1 + random.nextInt(maximumBlockSize);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample(channel, i, static_cast<SampleType>(random.nextFloat() * 0.5f - 0.25f));
+
+            juce::AudioBuffer<SampleType> view(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+            numAllocations = 0;
+            isCountingAllocations = true;
+            processor.processBlock(view, midi);
+            isCountingAllocations = false;
+
+            total += numAllocations.load();
+        }
+
+        return total;
+    }
+
+    template <typename SampleType>
+    void runWithPrecision(juce::AudioProcessor::ProcessingPrecision precision, const juce::String& name)
+    {
+        juce::Random random(0x5eed);
+
+        auto prepare = [precision](SimpleEQAudioProcessor& processor)
+            {
+                processor.setProcessingPrecision(precision);
+                processor.setRateAndBufferSizeDetails(sampleRate, maximumBlockSize);
+                processor.prepareToPlay(sampleRate, maximumBlockSize);
+
+                // The analyser FIFO is fed too, as with an editor open
+                processor.leftChannelFifo.attachConsumer();
+            };
+
+        beginTest("Steady state, " + name);
+        {
+            SimpleEQAudioProcessor processor;
+            setUpEq(processor);
+            prepare(processor);
+
+            countAllocations<SampleType>(processor, numWarmUpBlocks, random, {});
+            expectEquals(countAllocations<SampleType>(processor, numBlocks, random, {}), 0,
+                         "processBlock allocated with the settings held still");
+
+            processor.leftChannelFifo.detachConsumer();
+        }
+
+        beginTest("Automation, " + name);
+        {
+            SimpleEQAudioProcessor processor;
+            setUpEq(processor);
+            setUpSnapshots(processor);
+            prepare(processor);
+
+            const auto automatedParameters = getAutomatedParameters(processor);
+
+            countAllocations<SampleType>(processor, numWarmUpBlocks, random, {});
+            expectEquals(countAllocations<SampleType>(processor, numBlocks, random, automatedParameters), 0,
+                         "processBlock allocated while parameters changed");
+
+            processor.leftChannelFifo.detachConsumer();
+        }
+    }
+};
+
+static ProcessBlockAllocationTest processBlockAllocationTest;
@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+#include "FFTAnalyzer.h"
+
+//==============================================================================
+// Analyser timings, driven by hand rather than by the shared thread: each
+// frame pushes a display frame's worth of samples into the FIFO and updates
+// the producer, as the AnalyzerService does 60 times a second
+class AnalyzerBenchmark : public Benchmark
+{
+public:
+    using Benchmark::Benchmark;
+
+protected:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int framesPerSecond = 60;
+    static constexpr int samplesPerFrame = static_cast<int>(sampleRate) / framesPerSecond;
+    static constexpr float editorHeight = 400.0f;
+
+    struct Run
+    {
+        double secondsPerFrame = 0.0;
+        int numPaths = 0;
+    };
+
+    // One second of noise through the producer, best of several
+    Run measureFrames(const AnalyzerSettings& settings, float width)
+    {
+        SampleFifo fifo;
+        FFTPathProducer producer(fifo, false);
+        producer.setSettings(settings);
+        producer.setTarget({ 0.0f, 0.0f, width, editorHeight }, sampleRate, true);
+
+        juce::Random random(5);
+        std::vector<float> source(static_cast<size_t>(samplesPerFrame * framesPerSecond));
+
+        for (auto& sample : source)
+            sample = random.nextFloat() * 0.5f - 0.25f;
+
+        Run result;
+
+        auto run = [&]
+            {
+                result.numPaths = 0;
+
+                for (int frame = 0; frame < framesPerSecond; ++frame)
+                {
+                    fifo.push(source.data() + frame * samplesPerFrame, samplesPerFrame);
+                    producer.update();
+
+                    if (producer.fetchLatestPath())
+                        ++result.numPaths;
+                }
+            };
+
+        // Fills the histories and builds the pixel mapping
+        run();
+
+        result.secondsPerFrame = time(run) / framesPerSecond;
+        return result;
+    }
+};
+
+//==============================================================================
+// Cost of each resolution, overlap and the multi-resolution low end, against
+// how many of the 60 frames get a fresh spectrum
+class AnalyzerConfigurationBenchmark : public AnalyzerBenchmark
+{
+public:
+    AnalyzerConfigurationBenchmark() : AnalyzerBenchmark("Analyzer cost per configuration") {}
+
+    void runTest() override
+    {
+        beginTest("48 kHz, 1000 pixels wide");
+
+        struct Configuration
+        {
+            const char* name;
+            AnalyzerSettings settings;
+        };
+
+        const Configuration configurations[] = {
+            { "2048, no overlap",           { 11, 2048, false } },
+            { "2048, hop 512",              { 11, 512, false } },
+            { "2048, hop 256",              { 11, 256, false } },
+            { "8192, hop 512",              { 13, 512, false } },
+            { "16384, hop 512",             { 14, 512, false } },
+            { "2048 + 8192, hop 512",       { 11, 512, true } },
+            { "4096 + 16384, hop 512",      { 12, 512, true } },
+        };
+
+        for (const auto& configuration : configurations)
+        {
+            const auto result = measureFrames(configuration.settings, 1000.0f);
+            const juce::String name(configuration.name);
+
+            logResult(name + ", frame", result.secondsPerFrame * 1.0e6, "us");
+            logResult(name + ", fresh frames", static_cast<double>(result.numPaths), "per second");
+        }
+    }
+};
+
+static AnalyzerConfigurationBenchmark analyzerConfigurationBenchmark;
+
+//==============================================================================
+// Frame cost against editor width, up to a 4K-wide editor. The hop is one
+// display frame, so every frame runs one transform and builds one path;
+// what grows with the width is generatePath.
+class AnalyzerWidthBenchmark : public AnalyzerBenchmark
+{
+public:
+    AnalyzerWidthBenchmark() : AnalyzerBenchmark("Analyzer frame cost per width") {}
+
+    void runTest() override
+    {
+        for (auto multiResolution : { false, true })
+        {
+            beginTest(multiResolution ? "48 kHz, 2048 + 8192" : "48 kHz, 2048");
+
+            const AnalyzerSettings settings{ 11, samplesPerFrame, multiResolution };
+
+            for (auto width : { 1000.0f, 1920.0f, 3840.0f })
+            {
+                const auto result = measureFrames(settings, width);
+                const auto name = juce::String(static_cast<int>(width)) + " pixels";
+
+                logResult(name + ", frame", result.secondsPerFrame * 1.0e6, "us");
+                logResult(name + ", per pixel", result.secondsPerFrame * 1.0e9 / width, "ns");
+            }
+        }
+    }
+};
+
+static AnalyzerWidthBenchmark analyzerWidthBenchmark;
@@ -0,0 +1,50 @@
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Benchmarks are juce::UnitTests in their own category, run by the
+// SimpleEQBenchmarks app rather than by ctest; build it in Release for
+// meaningful numbers. Each measurement keeps the best of several runs, the
+// one least disturbed by the rest of the system.
+class Benchmark : public juce::UnitTest
+{
+public:
+    explicit Benchmark(const juce::String& name)
+        : juce::UnitTest(name, "SimpleEQ Benchmarks")
+    {
+    }
+
+protected:
+    static constexpr int numRuns = 7;
+
+    // Best time of numRuns calls, in seconds
+    template <typename Function>
+    static double time(Function&& function)
+    {
+        auto best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            function();
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(elapsed));
+        }
+
+        return best;
+    }
+
+    void logResult(const juce::String& label, double value, const juce::String& unit)
+    {
+        logMessage("  " + label.paddedRight(' ', 44) + juce::String(value, 2).paddedLeft(' ', 12) + " " + unit);
+    }
+
+    template <typename SampleType>
+    static void fillWithNoise(juce::AudioBuffer<SampleType>& buffer, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, static_cast<SampleType>(random.nextFloat() * 0.5f - 0.25f));
+    }
+};
@@ -0,0 +1,14 @@
+#include <JuceHeader.h>
+
+//==============================================================================
+// Runs every benchmark and logs its timings
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("SimpleEQ Benchmarks");
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+// The flat cascade against what it replaced: per channel, a chain of
+// juce::dsp::IIR::Filters running the same sections one after the other,
+// each with its own coefficient object and state. Both cuts run at every
+// slope, with three bands in between.
+class CascadeBenchmark : public Benchmark
+{
+public:
+    CascadeBenchmark() : Benchmark("Cascade vs IIR::Filter chain") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 512-sample blocks, two cuts and three bands");
+
+        for (int slope = Slope_12; slope <= Slope_96; ++slope)
+            measure(static_cast<Slope>(slope));
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numChannels = 2;
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 400;
+
+    static ChainSettings makeSettings(Slope slope)
+    {
+        ChainSettings settings;
+        settings.numBands = 3;
+        settings.lowCutFreq = 80.0f;
+        settings.lowCutSlope = slope;
+        settings.highCutFreq = 12000.0f;
+        settings.highCutSlope = slope;
+
+        for (int band = 0; band < settings.numBands; ++band)
+        {
+            settings.bands[static_cast<size_t>(band)].freq = 250.0f * static_cast<float>(1 << (2 * band));
+            settings.bands[static_cast<size_t>(band)].gain = 4.0f;
+        }
+
+        return settings;
+    }
+
+    void measure(Slope slope)
+    {
+        using Filter = juce::dsp::IIR::Filter<float>;
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+        BiquadCascade<float> cascade;
+        cascade.prepare({ sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) }, NumCascadeSections);
+        updateCascade(cascade, makeSettings(slope), sampleRate, allStages);
+
+        std::array<juce::OwnedArray<Filter>, numChannels> chains;
+
+        for (int section = 0; section < cascade.getNumSections(); ++section)
+        {
+            if (!cascade.isActive(section))
+                continue;
+
+            const auto* c = cascade.getCoefficients(section);
+
+            for (auto& chain : chains)
+                chain.add(new Filter(new Coefficients(c[0], c[1], c[2], 1.0f, c[3], c[4])));
+        }
+
+        juce::Random random(1);
+        juce::AudioBuffer<float> source(numChannels, blockSize), buffer(numChannels, blockSize);
+        fillWithNoise(source, random);
+
+        const auto chainSeconds = time([&]
+            {
+                for (int block = 0; block < numBlocks; ++block)
+                {
+                    buffer.makeCopyOf(source, true);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        auto channelBlock = juce::dsp::AudioBlock<float>(buffer).getSingleChannelBlock(static_cast<size_t>(channel));
+
+                        for (auto* filter : chains[static_cast<size_t>(channel)])
+                            filter->process(juce::dsp::ProcessContextReplacing<float>(channelBlock));
+                    }
+                }
+            });
+
+        const auto cascadeSeconds = time([&]
+            {
+                for (int block = 0; block < numBlocks; ++block)
+                {
+                    buffer.makeCopyOf(source, true);
+                    juce::dsp::AudioBlock<float> audioBlock(buffer);
+                    cascade.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+                }
+            });
+
+        const auto numSamples = static_cast<double>(numBlocks * blockSize);
+        const auto label = juce::String(12 * (slope + 1)) + " dB/oct, " + juce::String(cascade.getNumProcessedSections()) + " sections: ";
+
+        logResult(label + "IIR::Filter chain", chainSeconds * 1.0e9 / numSamples, "ns/sample");
+        logResult(label + "BiquadCascade", cascadeSeconds * 1.0e9 / numSamples, "ns/sample");
+        logResult(label + "speed-up", chainSeconds / cascadeSeconds, "x");
+
+        expectGreaterThan(cascadeSeconds, 0.0);
+    }
+};
+
+static CascadeBenchmark cascadeBenchmark;
@@ -0,0 +1,456 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+// Timings of the whole processBlock, stereo, with both cuts engaged and
+// every band away from 0 dB
+class ProcessorBenchmark : public Benchmark
+{
+public:
+    using Benchmark::Benchmark;
+
+protected:
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 200;
+
+    static void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterId, float value)
+    {
+        auto* parameter = processor.treeState.getParameter(parameterId);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    static void setUpEq(SimpleEQAudioProcessor& processor)
+    {
+        setParameter(processor, "LowCut Frequency", 30.0f);
+        setParameter(processor, "LowCut Slope", 3.0f);
+        setParameter(processor, "HighCut Frequency", 16000.0f);
+        setParameter(processor, "HighCut Slope", 1.0f);
+
+        for (int band = 1; band <= processor.numBands; ++band)
+            setParameter(processor, "Band" + juce::String(band) + " Gain", band % 2 == 0 ? 4.0f : -4.0f);
+    }
+
+    static void prepare(SimpleEQAudioProcessor& processor, double sampleRate, bool useDoublePrecision)
+    {
+        processor.setProcessingPrecision(useDoublePrecision ? juce::AudioProcessor::doublePrecision
+                                                            : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+    }
+
+    // Processes silence-free blocks while sleeping between them, so that
+    // background work such as the linear-phase kernel design lands
+    template <typename SampleType>
+    static void settle(SimpleEQAudioProcessor& processor, int milliseconds)
+    {
+        juce::Random random(3);
+        juce::AudioBuffer<SampleType> buffer(processor.getTotalNumInputChannels(), blockSize);
+        juce::MidiBuffer midi;
+
+        for (int elapsed = 0; elapsed < milliseconds; elapsed += 10)
+        {
+            fillWithNoise(buffer, random);
+            processor.processBlock(buffer, midi);
+            juce::Thread::sleep(10);
+        }
+    }
+
+    // Nanoseconds per sample frame of processBlock on noise. beforeBlock runs
+    // ahead of each block, inside the timing, to move parameters.
+    template <typename SampleType, typename BeforeBlock>
+    double measureProcessBlock(SimpleEQAudioProcessor& processor, BeforeBlock&& beforeBlock)
+    {
+        const int numChannels = processor.getTotalNumInputChannels();
+
+        juce::Random random(7);
+        juce::AudioBuffer<SampleType> source(numChannels, blockSize), buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        fillWithNoise(source, random);
+
+        auto run = [&]
+            {
+                for (int block = 0; block < numBlocks; ++block)
+                {
+                    beforeBlock(block);
+                    buffer.makeCopyOf(source, true);
+                    processor.processBlock(buffer, midi);
+                }
+            };
+
+        // Lets smoothing, fades and background designs settle
+        run();
+
+        return time(run) * 1.0e9 / (numBlocks * blockSize);
+    }
+
+    template <typename SampleType>
+    double measureProcessBlock(SimpleEQAudioProcessor& processor)
+    {
+        return measureProcessBlock<SampleType>(processor, [](int) {});
+    }
+};
+
+//==============================================================================
+// Double precision costs against float, per rate, to choose between the
+// accuracy of the double path and the throughput of the float one
+class PrecisionBenchmark : public ProcessorBenchmark
+{
+public:
+    PrecisionBenchmark() : ProcessorBenchmark("Float vs double processBlock") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 512-sample blocks");
+
+        for (auto sampleRate : { 44100.0, 96000.0, 192000.0 })
+        {
+            const auto rate = juce::String(sampleRate / 1000.0, 1) + " kHz, ";
+
+            SimpleEQAudioProcessor floatProcessor;
+            setUpEq(floatProcessor);
+            prepare(floatProcessor, sampleRate, false);
+            const auto floatCost = measureProcessBlock<float>(floatProcessor);
+
+            SimpleEQAudioProcessor doubleProcessor;
+            setUpEq(doubleProcessor);
+            prepare(doubleProcessor, sampleRate, true);
+            const auto doubleCost = measureProcessBlock<double>(doubleProcessor);
+
+            logResult(rate + "float", floatCost, "ns/sample");
+            logResult(rate + "double", doubleCost, "ns/sample");
+            logResult(rate + "double / float", doubleCost / floatCost, "x");
+
+            expectGreaterThan(floatCost, 0.0);
+        }
+    }
+};
+
+static PrecisionBenchmark precisionBenchmark;
+
+//==============================================================================
+// Linear phase at each kernel length against the minimum-phase cascade
+class LinearPhaseBenchmark : public ProcessorBenchmark
+{
+public:
+    LinearPhaseBenchmark() : ProcessorBenchmark("Linear phase vs minimum phase") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 48 kHz, 512-sample blocks");
+
+        constexpr double sampleRate = 48000.0;
+
+        SimpleEQAudioProcessor minimumPhase;
+        setUpEq(minimumPhase);
+        prepare(minimumPhase, sampleRate, false);
+        const auto minimumPhaseCost = measureProcessBlock<float>(minimumPhase);
+
+        logResult("Minimum phase", minimumPhaseCost, "ns/sample");
+
+        for (int length = 0; length < LinearPhaseFilter::numKernelLengths; ++length)
+        {
+            SimpleEQAudioProcessor linearPhase;
+            setUpEq(linearPhase);
+            setParameter(linearPhase, "Phase Mode", 1.0f);
+            setParameter(linearPhase, "Linear Phase Length", static_cast<float>(length));
+            prepare(linearPhase, sampleRate, false);
+
+            // The first kernel is designed and loaded in the background
+            settle<float>(linearPhase, 1000);
+            const auto cost = measureProcessBlock<float>(linearPhase);
+
+            const auto label = juce::String(LinearPhaseFilter::minimumKernelLength << length) + " taps";
+            logResult(label, cost, "ns/sample");
+            logResult(label + " / minimum phase", cost / minimumPhaseCost, "x");
+
+            expectGreaterThan(cost, 0.0);
+        }
+    }
+};
+
+static LinearPhaseBenchmark linearPhaseBenchmark;
+
+//==============================================================================
+// Each oversampling factor against running at the session rate, with the
+// latency it reports
+class OversamplingBenchmark : public ProcessorBenchmark
+{
+public:
+    OversamplingBenchmark() : ProcessorBenchmark("Oversampling factors") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 512-sample blocks");
+
+        const juce::StringArray factors{ "Off", "2x", "4x" };
+
+        for (auto sampleRate : { 44100.0, 48000.0 })
+        {
+            const auto rate = juce::String(sampleRate / 1000.0, 1) + " kHz, ";
+            double offCost = 0.0;
+
+            for (int order = 0; order < factors.size(); ++order)
+            {
+                SimpleEQAudioProcessor processor;
+                setUpEq(processor);
+                setParameter(processor, "Oversampling", static_cast<float>(order));
+                prepare(processor, sampleRate, false);
+
+                const auto cost = measureProcessBlock<float>(processor);
+
+                if (order == 0)
+                    offCost = cost;
+
+                const auto label = rate + factors[order];
+                logResult(label, cost, "ns/sample");
+                logResult(label + " / off", cost / offCost, "x");
+                logResult(label + " latency", processor.getLatencySamples(), "samples");
+
+                expectGreaterThan(cost, 0.0);
+            }
+        }
+    }
+};
+
+static OversamplingBenchmark oversamplingBenchmark;
+
+//==============================================================================
+// Matched designs against bilinear ones: the same sections run per sample,
+// so only redesigns, here every block with the band frequencies automated,
+// may differ
+class FilterDesignBenchmark : public ProcessorBenchmark
+{
+public:
+    FilterDesignBenchmark() : ProcessorBenchmark("Matched vs bilinear design") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 48 kHz, 512-sample blocks");
+
+        const juce::StringArray designs{ "Bilinear", "Matched" };
+
+        for (auto automated : { false, true })
+        {
+            double bilinearCost = 0.0;
+
+            for (int design = 0; design < designs.size(); ++design)
+            {
+                SimpleEQAudioProcessor processor;
+                setUpEq(processor);
+                setParameter(processor, "Filter Design", static_cast<float>(design));
+                prepare(processor, 48000.0, false);
+
+                const auto cost = measureProcessBlock<float>(processor, [&](int block)
+                    {
+                        if (!automated)
+                            return;
+
+                        for (int band = 1; band <= processor.numBands; ++band)
+                            setParameter(processor, "Band" + juce::String(band) + " Frequency",
+                                         1000.0f * static_cast<float>(band) + 10.0f * static_cast<float>(block % 32));
+                    });
+
+                if (design == 0)
+                    bilinearCost = cost;
+
+                const auto label = designs[design] + (automated ? ", frequencies automated" : ", static");
+                logResult(label, cost, "ns/sample");
+                logResult(label + " / bilinear", cost / bilinearCost, "x");
+
+                expectGreaterThan(cost, 0.0);
+            }
+        }
+    }
+};
+
+static FilterDesignBenchmark filterDesignBenchmark;
+
+//==============================================================================
+// What a band costs dynamic against static, the goal being under twice as
+// much. Band costs are taken over the same processor with every band flat,
+// which leaves only the cuts. With the sidechain, the detectors listen to
+// the sidechain bus instead of the main input.
+class DynamicBandBenchmark : public ProcessorBenchmark
+{
+public:
+    DynamicBandBenchmark() : ProcessorBenchmark("Dynamic vs static bands") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 48 kHz, 512-sample blocks");
+
+        for (auto useSidechain : { false, true })
+        {
+            const juce::String bus = useSidechain ? "sidechain, " : "main input, ";
+
+            const auto baseline = measure(Bands::Flat, useSidechain);
+            const auto staticCost = (measure(Bands::Static, useSidechain) - baseline) / numBandsMeasured;
+            const auto dynamicCost = (measure(Bands::Dynamic, useSidechain) - baseline) / numBandsMeasured;
+
+            logResult(bus + "static band", staticCost, "ns/sample");
+            logResult(bus + "dynamic band", dynamicCost, "ns/sample");
+            logResult(bus + "dynamic / static", dynamicCost / staticCost, "x");
+
+            expectGreaterThan(dynamicCost, 0.0);
+        }
+    }
+
+private:
+    enum class Bands { Flat, Static, Dynamic };
+
+    static constexpr double numBandsMeasured = SimpleEQAudioProcessor::defaultNumBands;
+
+    double measure(Bands bands, bool useSidechain)
+    {
+        SimpleEQAudioProcessor processor;
+        setUpEq(processor);
+
+        for (int band = 1; band <= processor.numBands; ++band)
+        {
+            const auto id = "Band" + juce::String(band);
+
+            if (bands == Bands::Flat)
+                setParameter(processor, id + " Gain", 0.0f);
+
+            // Low enough for the noise to keep every detector working
+            if (bands == Bands::Dynamic)
+            {
+                setParameter(processor, id + " Dynamic", 1.0f);
+                setParameter(processor, id + " Threshold", -40.0f);
+            }
+        }
+
+        if (useSidechain)
+        {
+            processor.getBus(true, 1)->enable();
+            setParameter(processor, "Sidechain", 1.0f);
+        }
+
+        prepare(processor, 48000.0, false);
+        return measureProcessBlock<float>(processor);
+    }
+};
+
+static DynamicBandBenchmark dynamicBandBenchmark;
+
+//==============================================================================
+// Each control interval under automation: every band frequency and gain
+// moves every block, so every sub-block redesigns stages
+class ControlIntervalBenchmark : public ProcessorBenchmark
+{
+public:
+    ControlIntervalBenchmark() : ProcessorBenchmark("Control interval under automation") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 48 kHz, 512-sample blocks");
+
+        for (int rate = 0; rate < 4; ++rate)
+        {
+            SimpleEQAudioProcessor processor;
+            setUpEq(processor);
+            setParameter(processor, "Control Rate", static_cast<float>(rate));
+            prepare(processor, 48000.0, false);
+
+            juce::uint32 updatesBefore = 0;
+            int numTimedBlocks = 0;
+
+            const auto cost = measureProcessBlock<float>(processor, [&](int block)
+                {
+                    // Counted over the last timed run
+                    if (block == 0)
+                    {
+                        updatesBefore = processor.getCoefficientUpdateCount();
+                        numTimedBlocks = 0;
+                    }
+
+                    ++numTimedBlocks;
+
+                    for (int band = 1; band <= processor.numBands; ++band)
+                    {
+                        const auto id = "Band" + juce::String(band);
+                        const auto phase = static_cast<float>((block + band) % 64) / 64.0f;
+
+                        setParameter(processor, id + " Frequency", 200.0f * static_cast<float>(band) * (1.0f + phase));
+                        setParameter(processor, id + " Gain", 8.0f * phase - 4.0f);
+                    }
+                });
+
+            const auto label = juce::String(processor.getControlInterval()) + " samples";
+            logResult(label, cost, "ns/sample");
+            logResult(label + ", redesigns",
+                      static_cast<double>(processor.getCoefficientUpdateCount() - updatesBefore) / numTimedBlocks, "stages/block");
+
+            expectGreaterThan(cost, 0.0);
+        }
+    }
+};
+
+static ControlIntervalBenchmark controlIntervalBenchmark;
+
+//==============================================================================
+// Morphing between two snapshots against the same EQ held on its parameters:
+// the blend is computed every control block, and while the position moves
+// every stage is redesigned
+class MorphBenchmark : public ProcessorBenchmark
+{
+public:
+    MorphBenchmark() : ProcessorBenchmark("Morph") {}
+
+    void runTest() override
+    {
+        beginTest("Stereo, 48 kHz, 512-sample blocks");
+
+        SimpleEQAudioProcessor unmorphed;
+        setUpEq(unmorphed);
+        prepare(unmorphed, 48000.0, false);
+        const auto unmorphedCost = measureProcessBlock<float>(unmorphed);
+
+        SimpleEQAudioProcessor held;
+        setUpSnapshots(held);
+        setParameter(held, "Morph", 0.5f);
+        prepare(held, 48000.0, false);
+        const auto heldCost = measureProcessBlock<float>(held);
+
+        SimpleEQAudioProcessor automated;
+        setUpSnapshots(automated);
+        prepare(automated, 48000.0, false);
+        const auto automatedCost = measureProcessBlock<float>(automated, [&](int block)
+            {
+                // A triangle sweeping both ways every 64 blocks
+                const auto phase = static_cast<float>(block % 64) / 32.0f;
+                setParameter(automated, "Morph", phase < 1.0f ? phase : 2.0f - phase);
+            });
+
+        logResult("Morph off", unmorphedCost, "ns/sample");
+        logResult("Morph on, position held", heldCost, "ns/sample");
+        logResult("Morph on, position automated", automatedCost, "ns/sample");
+        logResult("Held / off", heldCost / unmorphedCost, "x");
+        logResult("Automated / off", automatedCost / unmorphedCost, "x");
+
+        expectGreaterThan(automatedCost, 0.0);
+    }
+
+private:
+    // Slot A holds the EQ of setUpEq, slot B the same with the bands an
+    // octave up; morphing runs between them
+    static void setUpSnapshots(SimpleEQAudioProcessor& processor)
+    {
+        setUpEq(processor);
+        processor.storeSnapshot();
+        processor.selectSnapshot(1);
+
+        for (int band = 1; band <= processor.numBands; ++band)
+        {
+            auto* frequency = processor.treeState.getParameter("Band" + juce::String(band) + " Frequency");
+            setParameter(processor, "Band" + juce::String(band) + " Frequency",
+                         juce::jmin(20000.0f, 2.0f * frequency->convertFrom0to1(frequency->getValue())));
+        }
+
+        processor.storeSnapshot();
+        setParameter(processor, "Morph Enabled", 1.0f);
+    }
+};
+
+static MorphBenchmark morphBenchmark;
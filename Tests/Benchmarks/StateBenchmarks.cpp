@@ -0,0 +1,86 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+// Size and cost of the binary state against the ValueTree it replaced, for
+// a host saving and recalling a session many times over
+class StateBenchmark : public Benchmark
+{
+public:
+    StateBenchmark() : Benchmark("Binary vs ValueTree state") {}
+
+    void runTest() override
+    {
+        beginTest("Every parameter moved off its default");
+
+        SimpleEQAudioProcessor processor;
+        moveParameters(processor);
+
+        juce::MemoryBlock binaryState;
+        processor.getStateInformation(binaryState);
+
+        juce::MemoryBlock treeState;
+        writeTreeState(processor, treeState);
+
+        logResult("binary size", static_cast<double>(binaryState.getSize()), "bytes");
+        logResult("ValueTree size", static_cast<double>(treeState.getSize()), "bytes");
+
+        // getStateInformation appends, as hosts hand it an empty block; each
+        // call starts from one here too, like writeTreeState
+        const auto binarySave = time([&]
+            {
+                for (int i = 0; i < numCalls; ++i)
+                {
+                    binaryState.reset();
+                    processor.getStateInformation(binaryState);
+                }
+            });
+
+        const auto treeSave = time([&]
+            {
+                for (int i = 0; i < numCalls; ++i)
+                    writeTreeState(processor, treeState);
+            });
+
+        // setStateInformation takes either format; the ValueTree goes through
+        // readFromData and replaceState, as sessions from before the binary
+        // state do
+        const auto binaryLoad = time([&]
+            {
+                for (int i = 0; i < numCalls; ++i)
+                    processor.setStateInformation(binaryState.getData(), static_cast<int>(binaryState.getSize()));
+            });
+
+        const auto treeLoad = time([&]
+            {
+                for (int i = 0; i < numCalls; ++i)
+                    processor.setStateInformation(treeState.getData(), static_cast<int>(treeState.getSize()));
+            });
+
+        logResult("binary get", binarySave * 1.0e6 / numCalls, "us/call");
+        logResult("ValueTree get", treeSave * 1.0e6 / numCalls, "us/call");
+        logResult("binary set", binaryLoad * 1.0e6 / numCalls, "us/call");
+        logResult("ValueTree set", treeLoad * 1.0e6 / numCalls, "us/call");
+
+        // A session recalling 1,000 instances, one setStateInformation each
+        logResult("binary recall, 1,000 instances", binaryLoad * 1.0e3 * 1000.0 / numCalls, "ms");
+        logResult("ValueTree recall, 1,000 instances", treeLoad * 1.0e3 * 1000.0 / numCalls, "ms");
+    }
+
+private:
+    static constexpr int numCalls = 1000;
+
+    static void moveParameters(SimpleEQAudioProcessor& processor)
+    {
+        for (auto* parameter : processor.getParameters())
+            parameter->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, parameter->getDefaultValue() + 0.1f));
+    }
+
+    static void writeTreeState(SimpleEQAudioProcessor& processor, juce::MemoryBlock& destData)
+    {
+        juce::MemoryOutputStream stream(destData, false);
+        processor.treeState.copyState().writeToStream(stream);
+    }
+};
+
+static StateBenchmark stateBenchmark;
@@ -0,0 +1,206 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+// The cascade runs stereo pairs, and wider layouts in batches, in the lanes
+// of a SIMDRegister. Its output must be bit-identical to what the plugin
+// used to do: one chain of juce::dsp::IIR::Filters per channel, each chain
+// running the same sections in order.
+class CascadeStereoTest : public juce::UnitTest
+{
+public:
+    CascadeStereoTest() : juce::UnitTest("BiquadCascade against per-channel IIR::Filter chains", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        for (int numChannels : { 1, 2, 5 })
+        {
+            beginTest(juce::String(numChannels) + " channel(s), float");
+            expectMatchesChains<float>(numChannels);
+
+            beginTest(juce::String(numChannels) + " channel(s), double");
+            expectMatchesChains<double>(numChannels);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int maximumBlockSize = 512;
+    static constexpr int numBlocks = 64;
+
+    template <typename SampleType>
+    void expectMatchesChains(int numChannels)
+    {
+        using Filter = juce::dsp::IIR::Filter<SampleType>;
+        using Coefficients = juce::dsp::IIR::Coefficients<SampleType>;
+
+        ChainSettings settings;
+        settings.numBands = 4;
+        settings.lowCutFreq = 60.0f;
+        settings.lowCutSlope = Slope_48;
+        settings.highCutFreq = 9000.0f;
+        settings.highCutSlope = Slope_24;
+
+        for (int band = 0; band < settings.numBands; ++band)
+        {
+            auto& b = settings.bands[static_cast<size_t>(band)];
+            b.freq = 150.0f * static_cast<float>(1 << (2 * band));
+            b.gain = band % 2 == 0 ? 5.0f : -7.0f;
+            b.Q = 0.5f + static_cast<float>(band);
+        }
+
+        BiquadCascade<SampleType> cascade;
+        cascade.prepare({ sampleRate, static_cast<juce::uint32>(maximumBlockSize), static_cast<juce::uint32>(numChannels) }, NumCascadeSections);
+        updateCascade(cascade, settings, sampleRate, allStages);
+
+        std::vector<juce::OwnedArray<Filter>> chains(static_cast<size_t>(numChannels));
+
+        for (int section = 0; section < cascade.getNumSections(); ++section)
+        {
+            if (!cascade.isActive(section))
+                continue;
+
+            const auto* c = cascade.getCoefficients(section);
+
+            for (auto& chain : chains)
+                chain.add(new Filter(new Coefficients(c[0], c[1], c[2], SampleType(1), c[3], c[4])));
+        }
+
+        // Silence lets any switch-in fade finish without touching the state,
+        // which the chains start from too
+        juce::AudioBuffer<SampleType> silence(numChannels, maximumBlockSize);
+        silence.clear();
+
+        for (int i = 0; i < 4; ++i)
+        {
+            juce::dsp::AudioBlock<SampleType> block(silence);
+            cascade.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+        }
+
+        juce::Random random(42);
+        juce::AudioBuffer<SampleType> buffer(numChannels, maximumBlockSize), reference(numChannels, maximumBlockSize);
+        int numMismatches = 0;
+
+        for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+        {
+            // Odd lengths exercise the tails of the vector loops
+            const int numSamples = 1 + random.nextInt(maximumBlockSize);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample(channel, i, static_cast<SampleType>(random.nextFloat() * 2.0f - 1.0f));
+
+            reference.makeCopyOf(buffer, true);
+
+            auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubBlock(0, static_cast<size_t>(numSamples));
+            cascade.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto channelBlock = juce::dsp::AudioBlock<SampleType>(reference)
+                    .getSingleChannelBlock(static_cast<size_t>(channel))
+                    .getSubBlock(0, static_cast<size_t>(numSamples));
+
+                for (auto* filter : chains[static_cast<size_t>(channel)])
+                    filter->process(juce::dsp::ProcessContextReplacing<SampleType>(channelBlock));
+
+                for (int i = 0; i < numSamples; ++i)
+                    if (buffer.getSample(channel, i) != reference.getSample(channel, i))
+                        ++numMismatches;
+            }
+        }
+
+        expectEquals(numMismatches, 0, "Samples differing from the IIR::Filter chains");
+    }
+};
+
+static CascadeStereoTest cascadeStereoTest;
+
+//==============================================================================
+// Switching into or out of mid/side must carry the state across rather than
+// clear it. With the same coefficients on both channels the filters are
+// linear, so a cascade switching back and forth must follow one that never
+// switches.
+class CascadeMidSideSwitchTest : public juce::UnitTest
+{
+public:
+    CascadeMidSideSwitchTest() : juce::UnitTest("BiquadCascade mid/side switch", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        beginTest("Float");
+        expectSwitchIsSeamless<float>(1.0e-4);
+
+        beginTest("Double");
+        expectSwitchIsSeamless<double>(1.0e-10);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 256;
+    static constexpr int numBlocks = 16;
+
+    template <typename SampleType>
+    void expectSwitchIsSeamless(double tolerance)
+    {
+        using Cascade = BiquadCascade<SampleType>;
+
+        ChainSettings settings;
+        settings.numBands = 2;
+        settings.lowCutFreq = 40.0f;
+        settings.lowCutSlope = Slope_24;
+        settings.bands[0].freq = 120.0f;
+        settings.bands[0].gain = 8.0f;
+        settings.bands[1].freq = 3000.0f;
+        settings.bands[1].gain = -6.0f;
+        settings.bands[1].Q = 2.0f;
+
+        const juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32>(blockSize), 2 };
+
+        Cascade design, switching, reference;
+        design.prepare(spec, NumCascadeSections);
+        updateCascade(design, settings, sampleRate, allStages);
+
+        // The same design on both channels, whichever the mode
+        for (int section = 0; section < design.getNumSections(); ++section)
+            std::copy_n(design.getCoefficients(section, 0), CoefficientDesigner::biquadSize,
+                        design.getCoefficients(section, 1));
+
+        // Loaded without fades, so both start from the same silent state
+        switching.prepare(spec, NumCascadeSections);
+        switching.loadDesign(design);
+        reference.prepare(spec, NumCascadeSections);
+        reference.loadDesign(design);
+
+        juce::Random random(3);
+        juce::AudioBuffer<SampleType> buffer(2, blockSize), expected(2, blockSize);
+        double largestError = 0.0;
+
+        for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+        {
+            if (blockIndex > 0 && blockIndex % 4 == 0)
+                switching.setChannelMode(switching.getChannelMode() == Cascade::ChannelMode::MidSide
+                                             ? Cascade::ChannelMode::Shared
+                                             : Cascade::ChannelMode::MidSide);
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(channel, i, static_cast<SampleType>(random.nextFloat() - 0.5f));
+
+            expected.makeCopyOf(buffer, true);
+
+            juce::dsp::AudioBlock<SampleType> block(buffer), expectedBlock(expected);
+            switching.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+            reference.process(juce::dsp::ProcessContextReplacing<SampleType>(expectedBlock));
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    largestError = juce::jmax(largestError, static_cast<double>(std::abs(buffer.getSample(channel, i)
+                                                                                         - expected.getSample(channel, i))));
+        }
+
+        expectLessThan(largestError, tolerance, "Largest difference from the cascade that never switches");
+    }
+};
+
+static CascadeMidSideSwitchTest cascadeMidSideSwitchTest;
@@ -0,0 +1,142 @@
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+
+//==============================================================================
+// The matched designs must follow the analog prototype's magnitude all the
+// way up to Nyquist, where the bilinear designs they replace are cramped.
+// Peaks are checked across gains, Qs and centre frequencies; the low-pass
+// (the high-cut sections) wherever the prototype is above -24 dB, below
+// which a cut's error no longer matters.
+class MatchedDesignTest : public juce::UnitTest
+{
+public:
+    MatchedDesignTest() : juce::UnitTest("Matched designs against the analog prototypes", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        beginTest("Peak");
+
+        for (auto gainDb : { 12.0, -12.0 })
+            for (auto Q : { 0.7, 2.0 })
+                for (auto frequency : { 1000.0, 5000.0, 10000.0, 15000.0 })
+                    expectPeakMatches(frequency, Q, gainDb);
+
+        beginTest("Low-pass");
+
+        for (auto Q : { 0.5, 0.7071, 1.3 })
+            for (auto frequency : { 1000.0, 5000.0, 10000.0, 15000.0 })
+                expectLowPassMatches(frequency, Q);
+    }
+
+private:
+    using Complex = std::complex<double>;
+
+    static constexpr double sampleRate = 48000.0;
+
+    // Checked from 20 Hz to 95% of Nyquist, every 1% in frequency
+    static constexpr double lowestFrequency = 20.0;
+    static constexpr double highestFrequency = 0.95 * sampleRate * 0.5;
+    static constexpr double frequencyStep = 1.01;
+
+    static constexpr double peakTolerance = 1.0;
+    static constexpr double lowPassTolerance = 1.5;
+    static constexpr double lowPassFloor = -24.0;
+    static constexpr double exactTolerance = 1.0e-6;
+
+    // Above this the bilinear designs are expected to be off by at least
+    // twice as much as the matched ones
+    static constexpr double crampingFrequency = 5000.0;
+
+    static double getMagnitudeDb(const double* coefficients, double frequency)
+    {
+        const auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        const auto numerator = coefficients[0] + (coefficients[1] + coefficients[2] * z) * z;
+        const auto denominator = 1.0 + (coefficients[3] + coefficients[4] * z) * z;
+
+        return juce::Decibels::gainToDecibels(std::abs(numerator / denominator), -400.0);
+    }
+
+    // (s^2 + s A / Q + 1) / (s^2 + s / (A Q) + 1), A = sqrt(gain)
+    static double getAnalogPeakDb(double frequency, double centreFrequency, double Q, double gainFactor)
+    {
+        const auto A = std::sqrt(gainFactor);
+        const Complex s(0.0, frequency / centreFrequency);
+
+        return juce::Decibels::gainToDecibels(std::abs((s * s + s * A / Q + 1.0) / (s * s + s / (A * Q) + 1.0)), -400.0);
+    }
+
+    // 1 / (s^2 + s / Q + 1)
+    static double getAnalogLowPassDb(double frequency, double cutoff, double Q)
+    {
+        const Complex s(0.0, frequency / cutoff);
+
+        return juce::Decibels::gainToDecibels(std::abs(1.0 / (s * s + s / Q + 1.0)), -400.0);
+    }
+
+    template <typename AnalogDb>
+    static void getMaximumErrors(const double* matched, const double* bilinear, AnalogDb&& analogDb, double floorDb,
+                                 double& matchedError, double& bilinearError)
+    {
+        matchedError = bilinearError = 0.0;
+
+        for (auto frequency = lowestFrequency; frequency < highestFrequency; frequency *= frequencyStep)
+        {
+            const auto analog = analogDb(frequency);
+
+            if (analog < floorDb)
+                continue;
+
+            matchedError = juce::jmax(matchedError, std::abs(getMagnitudeDb(matched, frequency) - analog));
+            bilinearError = juce::jmax(bilinearError, std::abs(getMagnitudeDb(bilinear, frequency) - analog));
+        }
+    }
+
+    void expectPeakMatches(double frequency, double Q, double gainDb)
+    {
+        const auto gainFactor = juce::Decibels::decibelsToGain(gainDb);
+        const auto name = juce::String(gainDb) + " dB, Q " + juce::String(Q) + " at " + juce::String(frequency) + " Hz: ";
+
+        double matched[CoefficientDesigner::biquadSize], bilinear[CoefficientDesigner::biquadSize];
+        CoefficientDesigner::makeMatchedPeak(matched, sampleRate, frequency, Q, gainFactor);
+        CoefficientDesigner::makePeak(bilinear, sampleRate, frequency, Q, gainFactor);
+
+        auto analogDb = [&](double f) { return getAnalogPeakDb(f, frequency, Q, gainFactor); };
+
+        double matchedError, bilinearError;
+        getMaximumErrors(matched, bilinear, analogDb, -400.0, matchedError, bilinearError);
+
+        expectLessOrEqual(matchedError, peakTolerance, name + "largest error");
+
+        // The matching points themselves are exact
+        expectWithinAbsoluteError(getMagnitudeDb(matched, 0.0), 0.0, exactTolerance, name + "DC");
+        expectWithinAbsoluteError(getMagnitudeDb(matched, frequency), gainDb, exactTolerance, name + "centre");
+        expectWithinAbsoluteError(getMagnitudeDb(matched, sampleRate * 0.5), analogDb(sampleRate * 0.5), exactTolerance, name + "Nyquist");
+
+        if (frequency >= crampingFrequency)
+            expectGreaterThan(bilinearError, 2.0 * matchedError, name + "bilinear against matched error");
+    }
+
+    void expectLowPassMatches(double frequency, double Q)
+    {
+        const auto name = "Q " + juce::String(Q) + " at " + juce::String(frequency) + " Hz: ";
+
+        double matched[CoefficientDesigner::biquadSize], bilinear[CoefficientDesigner::biquadSize];
+        CoefficientDesigner::makeMatchedLowPass(matched, sampleRate, frequency, Q);
+        CoefficientDesigner::makeLowPass(bilinear, sampleRate, frequency, Q);
+
+        auto analogDb = [&](double f) { return getAnalogLowPassDb(f, frequency, Q); };
+
+        double matchedError, bilinearError;
+        getMaximumErrors(matched, bilinear, analogDb, lowPassFloor, matchedError, bilinearError);
+
+        expectLessOrEqual(matchedError, lowPassTolerance, name + "largest error");
+
+        expectWithinAbsoluteError(getMagnitudeDb(matched, 0.0), 0.0, exactTolerance, name + "DC");
+        expectWithinAbsoluteError(getMagnitudeDb(matched, sampleRate * 0.5), analogDb(sampleRate * 0.5), exactTolerance, name + "Nyquist");
+
+        if (frequency >= crampingFrequency)
+            expectGreaterThan(bilinearError, 2.0 * matchedError, name + "bilinear against matched error");
+    }
+};
+
+static MatchedDesignTest matchedDesignTest;
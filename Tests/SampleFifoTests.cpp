@@ -0,0 +1,104 @@
+#include <JuceHeader.h>
+#include "FFTAnalyzer.h"
+
+//==============================================================================
+// Blocks longer than the FIFO must still get through, and decimation must
+// low-pass before it drops samples: the audible band passes untouched while
+// what would fold back into it is rejected.
+class SampleFifoTest : public juce::UnitTest
+{
+public:
+    SampleFifoTest() : juce::UnitTest("Analyzer sample FIFO", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        beginTest("Blocks longer than the FIFO");
+        expectLongBlockGetsThrough();
+
+        beginTest("Decimation factors");
+        expectEquals(SampleFifo::getDecimationFor(44100.0), 1);
+        expectEquals(SampleFifo::getDecimationFor(96000.0), 2);
+        expectEquals(SampleFifo::getDecimationFor(192000.0), 4);
+        expectEquals(SampleFifo::getDecimationFor(768000.0), SampleFifo::maxDecimation);
+
+        beginTest("Half-band decimation at 192 kHz");
+
+        for (auto frequency : { 1000.0, 10000.0, 20000.0 })
+            expectWithinAbsoluteError(getDecimatedGainDb(frequency, true), 0.0, passbandTolerance,
+                                      juce::String(frequency) + " Hz");
+
+        for (auto frequency : { 30000.0, 60000.0 })
+            expectLessThan(getDecimatedGainDb(frequency, true), stopbandFloor, juce::String(frequency) + " Hz");
+
+        beginTest("Decimation off");
+        expectWithinAbsoluteError(getDecimatedGainDb(30000.0, false), 0.0, passbandTolerance, "30000 Hz");
+    }
+
+private:
+    static constexpr double sampleRate = 192000.0;
+    static constexpr int blockSize = 1000;
+    static constexpr int numSamples = 32768;
+    static constexpr int settleSamples = 200;
+    static constexpr double passbandTolerance = 0.01;
+    static constexpr double stopbandFloor = -70.0;
+
+    void expectLongBlockGetsThrough()
+    {
+        SampleFifo fifo;
+        fifo.attachConsumer();
+        fifo.setDecimationEnabled(false);
+
+        // Bigger than the whole FIFO: it fills in whole chunks, and only the
+        // chunks that no longer fit are dropped
+        std::vector<float> block(20000, 0.1f);
+        fifo.push(block.data(), static_cast<int>(block.size()));
+
+        expectGreaterThan(fifo.getNumReady(), static_cast<int>(block.size()) / 4, "Samples stored");
+        expectGreaterThan(static_cast<int>(fifo.getNumOverruns()), 0, "Chunks dropped");
+
+        fifo.detachConsumer();
+    }
+
+    // Level of a unit sine after the FIFO, past the filters' start-up
+    static double getDecimatedGainDb(double frequency, bool shouldDecimate)
+    {
+        SampleFifo fifo;
+        fifo.attachConsumer();
+        fifo.setDecimation(SampleFifo::getDecimationFor(sampleRate));
+        fifo.setDecimationEnabled(shouldDecimate);
+
+        std::vector<double> input(static_cast<size_t>(numSamples));
+
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = std::sin(juce::MathConstants<double>::twoPi * frequency * static_cast<double>(i) / sampleRate);
+
+        double sumOfSquares = 0.0;
+        int count = 0;
+
+        // Read as it goes, as the analyser does, so nothing is dropped
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            fifo.push(input.data() + start, juce::jmin(blockSize, numSamples - start));
+
+            const auto spans = fifo.prepareRead();
+
+            auto accumulate = [&](const float* samples, int size)
+                {
+                    for (int i = 0; i < size; ++i, ++count)
+                        if (count >= settleSamples)
+                            sumOfSquares += static_cast<double>(samples[i]) * samples[i];
+                };
+
+            accumulate(spans.first, spans.firstSize);
+            accumulate(spans.second, spans.secondSize);
+            fifo.finishRead(spans.size());
+        }
+
+        fifo.detachConsumer();
+
+        const auto rms = std::sqrt(sumOfSquares / (count - settleSamples));
+        return juce::Decibels::gainToDecibels(rms * juce::MathConstants<double>::sqrt2, -200.0);
+    }
+};
+
+static SampleFifoTest sampleFifoTest;
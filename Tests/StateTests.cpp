@@ -0,0 +1,225 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+// The binary state must load back every parameter and snapshot it saved,
+// keep reading ValueTree states, and stay binary: a hash collision between
+// the IDs would make it fall back to the ValueTree.
+class StateTest : public juce::UnitTest
+{
+public:
+    StateTest() : juce::UnitTest("Binary state", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        beginTest("FNV-1a parameter ID hash");
+        expectEquals(static_cast<juce::int64>(getParameterIdHash({})), static_cast<juce::int64>(0x811c9dc5));
+        expectEquals(static_cast<juce::int64>(getParameterIdHash("a")), static_cast<juce::int64>(0xe40c292c));
+        expectEquals(static_cast<juce::int64>(getParameterIdHash("foobar")), static_cast<juce::int64>(0xbf9cf968));
+
+        beginTest("Round trip");
+        expectRoundTrip();
+
+        beginTest("ValueTree state");
+        expectValueTreeLoads();
+
+        beginTest("Snapshots");
+        expectSnapshotsRoundTrip();
+
+        beginTest("Morph after a reload");
+        expectMorphFollowsRestoredSnapshots();
+    }
+
+private:
+    static constexpr int stateMagic = 0x42514553;      // "SEQB"
+    static constexpr int stateVersion = 1;
+    static constexpr int stateHeaderSize = 3 * 4;
+    static constexpr int stateEntrySize = 2 * 4;
+
+    static void setParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterId, float value)
+    {
+        auto* parameter = processor.treeState.getParameter(parameterId);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    static float getParameter(SimpleEQAudioProcessor& processor, const juce::String& parameterId)
+    {
+        auto* parameter = processor.treeState.getParameter(parameterId);
+        jassert(parameter != nullptr);
+        return parameter->convertFrom0to1(parameter->getValue());
+    }
+
+    static void setUpEq(SimpleEQAudioProcessor& processor)
+    {
+        setParameter(processor, "LowCut Frequency", 45.0f);
+        setParameter(processor, "LowCut Slope", 2.0f);
+        setParameter(processor, "HighCut Frequency", 12000.0f);
+
+        for (int band = 1; band <= processor.numBands; ++band)
+            setParameter(processor, "Band" + juce::String(band) + " Gain", band % 2 == 0 ? 3.0f : -6.0f);
+    }
+
+    static int getNumRangedParameters(SimpleEQAudioProcessor& processor)
+    {
+        int numParameters = 0;
+
+        for (auto* parameter : processor.getParameters())
+            if (dynamic_cast<juce::RangedAudioParameter*>(parameter) != nullptr)
+                ++numParameters;
+
+        return numParameters;
+    }
+
+    void expectSameParameters(SimpleEQAudioProcessor& expected, SimpleEQAudioProcessor& actual)
+    {
+        const auto& expectedParameters = expected.getParameters();
+        const auto& actualParameters = actual.getParameters();
+
+        expectEquals(actualParameters.size(), expectedParameters.size(), "Number of parameters");
+
+        for (int i = 0; i < juce::jmin(expectedParameters.size(), actualParameters.size()); ++i)
+            expectWithinAbsoluteError(actualParameters[i]->getValue(), expectedParameters[i]->getValue(), 1.0e-6f,
+                                      expectedParameters[i]->getName(64));
+    }
+
+    void expectRoundTrip()
+    {
+        SimpleEQAudioProcessor source;
+        setUpEq(source);
+
+        juce::MemoryBlock state;
+        source.getStateInformation(state);
+
+        // No two IDs share a hash, so the state is binary
+        const auto numEntries = getNumRangedParameters(source);
+        expectEquals(static_cast<int>(state.getSize()), stateHeaderSize + numEntries * stateEntrySize, "State size");
+
+        juce::MemoryInputStream stream(state, false);
+        expectEquals(stream.readInt(), stateMagic, "Magic");
+        expectEquals(stream.readInt(), stateVersion, "Version");
+        expectEquals(stream.readInt(), numEntries, "Entries");
+
+        SimpleEQAudioProcessor destination;
+        destination.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+        expectSameParameters(source, destination);
+    }
+
+    void expectValueTreeLoads()
+    {
+        SimpleEQAudioProcessor source;
+        setUpEq(source);
+
+        juce::MemoryBlock state;
+        juce::MemoryOutputStream stream(state, false);
+        source.treeState.copyState().writeToStream(stream);
+        stream.flush();
+
+        SimpleEQAudioProcessor destination;
+        destination.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+        expectSameParameters(source, destination);
+    }
+
+    // A, B and C hold different gains and D nothing. A is selected, with the
+    // parameters moved on since it was stored.
+    void expectSnapshotsRoundTrip()
+    {
+        SimpleEQAudioProcessor source;
+        setUpEq(source);
+        source.storeSnapshot();
+
+        source.selectSnapshot(1);
+        setParameter(source, "Band1 Gain", 9.0f);
+        source.storeSnapshot();
+
+        source.selectSnapshot(2);
+        setParameter(source, "Band1 Gain", 4.0f);
+        source.storeSnapshot();
+
+        source.selectSnapshot(0);
+        setParameter(source, "Band1 Gain", 2.0f);
+
+        juce::MemoryBlock state;
+        source.getStateInformation(state);
+
+        SimpleEQAudioProcessor destination;
+        destination.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+        expectSameParameters(source, destination);
+        expectEquals(destination.getSelectedSnapshot(), 0, "Selected slot");
+
+        for (int slot = 0; slot < 3; ++slot)
+            expect(destination.hasSnapshot(slot), "Slot " + juce::String(slot) + " stored");
+
+        expect(!destination.hasSnapshot(3), "Slot 3 empty");
+
+        // Selecting a slot recalls what it holds
+        destination.selectSnapshot(1);
+        expectWithinAbsoluteError(getParameter(destination, "Band1 Gain"), 9.0f, 1.0e-3f, "B's gain");
+        expectWithinAbsoluteError(getParameter(destination, "LowCut Frequency"), 45.0f, 1.0e-3f, "B's low cut");
+
+        destination.selectSnapshot(2);
+        expectWithinAbsoluteError(getParameter(destination, "Band1 Gain"), 4.0f, 1.0e-3f, "C's gain");
+
+        // A state without snapshots empties the slots
+        SimpleEQAudioProcessor empty;
+        juce::MemoryBlock emptyState;
+        empty.getStateInformation(emptyState);
+        destination.setStateInformation(emptyState.getData(), static_cast<int>(emptyState.getSize()));
+
+        for (int slot = 0; slot < SimpleEQAudioProcessor::numSnapshots; ++slot)
+            expect(!destination.hasSnapshot(slot), "Slot " + juce::String(slot) + " cleared");
+    }
+
+    // Morphed all the way to B, a reloaded instance must run B's settings
+    // rather than the parameters
+    void expectMorphFollowsRestoredSnapshots()
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+
+        SimpleEQAudioProcessor source;
+        setUpEq(source);
+        source.storeSnapshot();
+
+        source.selectSnapshot(1);
+        setParameter(source, "Band1 Gain", 9.0f);
+        source.storeSnapshot();
+
+        setParameter(source, "Band1 Gain", 2.0f);
+        setParameter(source, "Morph", 1.0f);
+        setParameter(source, "Morph Enabled", 1.0f);
+
+        juce::MemoryBlock state;
+        source.getStateInformation(state);
+
+        SimpleEQAudioProcessor destination;
+        destination.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+        destination.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        destination.prepareToPlay(sampleRate, blockSize);
+
+        juce::Random random(11);
+        juce::AudioBuffer<float> buffer(destination.getTotalNumInputChannels(), blockSize);
+        juce::MidiBuffer midi;
+
+        // Long enough for the smoothing to settle
+        for (int block = 0; block < 20; ++block)
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(channel, i, random.nextFloat() * 0.5f - 0.25f);
+
+            destination.processBlock(buffer, midi);
+        }
+
+        ChainSettings applied;
+        expect(destination.getAppliedSettings(applied) != 0, "Settings applied");
+        expectWithinAbsoluteError(applied.bands[0].gain, 9.0f, 1.0e-2f, "Band1 gain at B");
+
+        destination.releaseResources();
+    }
+};
+
+static StateTest stateTest;
@@ -0,0 +1,113 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+// With the state-variable engine, the cuts and bands leave the cascade for
+// ModulatedBands. Held still, they must filter as the biquads they replace:
+// the state-variable forms match the bilinear designs, and the cut sections
+// use the same Qs.
+class StateVariableEngineTest : public juce::UnitTest
+{
+public:
+    StateVariableEngineTest() : juce::UnitTest("State-variable engine against the cascade", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        for (auto alignment : { Alignment_Butterworth, Alignment_LinkwitzRiley })
+        {
+            const auto name = alignment == Alignment_Butterworth ? juce::String("Butterworth cuts, ") : juce::String("Linkwitz-Riley cuts, ");
+
+            beginTest(name + "float");
+            expectMatchesCascade<float>(alignment, 1.0e-4);
+
+            beginTest(name + "double");
+            expectMatchesCascade<double>(alignment, 1.0e-6);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numChannels = 2;
+    static constexpr int controlInterval = 32;
+    static constexpr int numBlocks = 256;
+
+    static ChainSettings makeSettings(CutAlignment alignment)
+    {
+        ChainSettings settings;
+        settings.numBands = 4;
+        settings.lowCutFreq = 60.0f;
+        settings.lowCutSlope = Slope_48;
+        settings.lowCutAlignment = alignment;
+        settings.highCutFreq = 9000.0f;
+        settings.highCutSlope = Slope_36;
+        settings.highCutAlignment = alignment;
+
+        const std::array<BandType, 4> types{ Band_Bell, Band_LowShelf, Band_HighShelf, Band_Notch };
+
+        for (int band = 0; band < settings.numBands; ++band)
+        {
+            auto& b = settings.bands[static_cast<size_t>(band)];
+            b.type = types[static_cast<size_t>(band)];
+            b.freq = 150.0f * static_cast<float>(1 << (2 * band));
+            b.gain = band % 2 == 0 ? 5.0f : -7.0f;
+            b.Q = 0.5f + static_cast<float>(band);
+        }
+
+        return settings;
+    }
+
+    template <typename SampleType>
+    void expectMatchesCascade(CutAlignment alignment, double tolerance)
+    {
+        const juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32>(controlInterval), static_cast<juce::uint32>(numChannels) };
+
+        auto settings = makeSettings(alignment);
+
+        BiquadCascade<SampleType> cascade;
+        cascade.prepare(spec, NumCascadeSections);
+        updateCascade(cascade, settings, sampleRate, allStages);
+
+        settings.filterEngine = Engine_StateVariable;
+
+        // The cascade the engine runs after has nothing left to do
+        BiquadCascade<SampleType> emptyCascade;
+        emptyCascade.prepare(spec, NumCascadeSections);
+        updateCascade(emptyCascade, settings, sampleRate, allStages);
+        expectEquals(emptyCascade.getNumProcessedSections(), 0, "Sections left in the cascade");
+
+        ModulatedBands<SampleType> engine;
+        engine.prepare(spec, settings.numBands, maxCutSections);
+        updateModulatedBands(engine, settings);
+
+        juce::Random random(12);
+        juce::AudioBuffer<SampleType> buffer(numChannels, controlInterval), reference(numChannels, controlInterval);
+        double largestError = 0.0;
+
+        for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < controlInterval; ++i)
+                    buffer.setSample(channel, i, static_cast<SampleType>(random.nextFloat() - 0.5f));
+
+            reference.makeCopyOf(buffer, true);
+
+            // As in processBlock, the settings are applied every control block
+            updateModulatedBands(engine, settings);
+
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+            engine.followEnvelope(block);
+            engine.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+
+            juce::dsp::AudioBlock<SampleType> referenceBlock(reference);
+            cascade.process(juce::dsp::ProcessContextReplacing<SampleType>(referenceBlock));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < controlInterval; ++i)
+                    largestError = juce::jmax(largestError, static_cast<double>(std::abs(buffer.getSample(channel, i) - reference.getSample(channel, i))));
+        }
+
+        expectLessOrEqual(largestError, tolerance, "Largest difference from the cascade");
+    }
+};
+
+static StateVariableEngineTest stateVariableEngineTest;
@@ -0,0 +1,21 @@
+#include <JuceHeader.h>
+
+//==============================================================================
+// Runs every juce::UnitTest in the "SimpleEQ" category. The exit code is the
+// number of tests with failures, so ctest sees any of them fail.
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("SimpleEQ");
+
+    int numFailedTests = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        if (runner.getResult(i)->failures > 0)
+            ++numFailedTests;
+
+    return numFailedTests;
+}